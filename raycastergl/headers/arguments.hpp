@@ -7,6 +7,34 @@ struct Arguments {
     int32_t vsync;
     std::string map;
     glm::ivec2 initialWindowSize;
+    std::string spriteRenderer;
+    float targetFrameMs;
+    float minRenderScale;
+    uint32_t rayRefineStep;
+    float drawDistance;
+    bool benchmarkMapLayout;
+    bool benchmarkEntityQueries;
+    double tickRate;
+    uint32_t maxFramesInFlight;
+    double maxFps;
+    double statsInterval;
+    std::string statsFile;
+    std::string metrics;
+    std::string stream;
+    uint32_t checkAllocations;
+    bool memoryReport;
+    uint32_t batchCameras;
+    glm::ivec2 batchSize;
+    std::string batchOutput;
+    uint32_t batchFrames;
+
+    inline bool useSpriteQuads() const {
+        return spriteRenderer == "quads";
+    }
+
+    inline bool useBatchTensor() const {
+        return batchOutput == "tensor";
+    }
 
     bool parseArguments(int argc, const char* const argv[]);
 };
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdint.h>
+#include <engine/batch-renderer.hpp>
+#include <engine/map.hpp>
+#include <opengl/texture.hpp>
+
+// renders batches of 1, 2, 4... up to the max cameras of the renderer (agents placed in random free cells
+// of the map, turning around) and reads the images after each batch, then prints the time of a batch and
+// the images per second of each size. Returns the exit code for main.
+int runBatchRenderingBenchmark(BatchRenderer& renderer, Map& map, Texture& textures, uint32_t batches);
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stdint.h>
+
+// moves many entities with random velocities through a random map (sliding along the walls), keeping them
+// in a SpatialHash, and prints the time of the moves and of the radius and nearest queries. Some queries
+// are checked (and timed) against testing every entity. Returns the exit code for main.
+int runEntityQueriesBenchmark(uint32_t entityCount = 100000);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stdint.h>
+
+// walks random rays (the DDA of the raycaster) over a big random map stored by rows and in tiles (MapGrid),
+// and prints the time of both layouts. Returns the exit code for main.
+int runMapLayoutBenchmark(uint32_t mapSize = 4096);
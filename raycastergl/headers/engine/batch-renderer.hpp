@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <opengl/buffer.hpp>
+#include <opengl/shader.hpp>
+#include <opengl/shader-program.hpp>
+#include <opengl/texture.hpp>
+#include "map.hpp"
+
+using namespace glm;
+
+// camera of an agent in the batch mode (the camera struct in res/shaders/include/camera.glsl)
+struct BatchCamera {
+    vec2 position;
+    vec2 direction;
+    vec2 plane;
+};
+
+static_assert(sizeof(BatchCamera) == 24, "BatchCamera must match the std430 layout of camera");
+
+// renders the views of many cameras (agents) in the same map at once: each pass (raycaster, spritecaster,
+// floorcaster and drawer) is one dispatch for all the cameras, the camera is one of the indices of the groups.
+// The images go into the layers of a texture array, or into a buffer packed as a [camera][row][column]
+// RGBA8 tensor with the rows from the top (ready to be read as observations).
+class BatchRenderer {
+public:
+    enum Output {
+        Layers,
+        Tensor,
+    };
+
+private:
+    uint32_t maxCameras;
+    ivec2 size;
+    Output output;
+    uint32_t spriteCount = 0;
+
+    ShaderProgram raycasterProgram;
+    ShaderProgram spritecasterProgram;
+    ShaderProgram floorcasterProgram;
+    ShaderProgram drawerProgram;
+    Buffer camerasBuffer;
+    Buffer columnsBuffer;
+    Buffer spritesBuffer;
+    Buffer spriteResultsBuffer;
+    // only one of them has storage, depending on the output
+    Buffer tensorBuffer;
+    Texture layersTexture;
+
+public:
+    BatchRenderer(uint32_t maxCameras, ivec2 size, Output output);
+
+    BatchRenderer(const BatchRenderer&) = delete;
+    BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+    inline uint32_t getMaxCameras() const {
+        return maxCameras;
+    }
+
+    inline size_t imageBytes() const {
+        return size_t(size.x) * size.y * 4;
+    }
+
+    // compiles the shaders for the floor and ceiling of the map, call it only once (the first maxSprites
+    // entities of the map are uploaded in each render)
+    bool load(Map& map, const Shader::Defines& textureDefines, uint32_t rayRefineStep);
+    // the images of the first count cameras are replaced (count cannot be more than the max cameras)
+    void render(Map& map, Texture& textures, const BatchCamera* cameras, uint32_t count);
+    // the images of the first count cameras as RGBA8, waits for the GPU. The rows of the tensor are from
+    // the top, and the rows of the layers are from the bottom (like the other OpenGL images)
+    void readImages(std::vector<uint8_t>& pixels, uint32_t count);
+};
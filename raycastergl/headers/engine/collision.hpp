@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <glm/vec2.hpp>
+#include "map-grid.hpp"
+#include "spatial-hash.hpp"
+
+// moves a circle through the map: the walls (and the outside of the map) push it out, so it slides along
+// them instead of stopping. Long movements are done in steps, so the circle cannot go through a wall.
+glm::vec2 moveCircle(const MapGrid& grid, glm::vec2 pos, glm::vec2 movement, float radius);
+
+// pushes a circle out of the entities that it touches (except ignore), nearby is used to store the query
+glm::vec2 separateCircle(
+    const SpatialHash& entities,
+    glm::vec2 pos,
+    float radius,
+    std::vector<uint32_t>& nearby,
+    uint32_t ignore = SpatialHash::none
+);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+// packed result of the raycaster for a screen column (the xdata struct in the shaders), only the values
+// that cannot be recalculated are stored: the draw bounds and texture step come from the distance.
+//
+// this list is the only definition of the packed fields, the GLSL code is generated from it
+// (see columnDataGlsl) so the shaders and the C++ side cannot get out of sync.
+//  F(name, first bit, bit count)
+#define COLUMN_DATA_FIELDS(F) \
+    F(side, 0, 1) \
+    F(textureNum, 1, 8) \
+    F(texX, 9, 12)
+
+struct ColumnData {
+    uint32_t bits;
+    // perpendicular distance to the wall, it is also the depth of the column
+    float distWall;
+
+#define COLUMN_DATA_ACCESSOR(name, offset, count) \
+    inline uint32_t name() const { \
+        return (bits >> offset) & ((1u << count) - 1u); \
+    }
+    COLUMN_DATA_FIELDS(COLUMN_DATA_ACCESSOR)
+#undef COLUMN_DATA_ACCESSOR
+};
+
+static_assert(sizeof(ColumnData) == 8, "ColumnData must match the std430 layout of xdata");
+
+// the xdata struct and its accessors (xdataSide, xdataTextureNum...) and packXdata for the shaders
+std::string columnDataGlsl();
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <opengl/buffer.hpp>
+#include "sprite.hpp"
+
+// an entity of an EntityStore, it stays valid until the entity is destroyed (then the id is reused with
+// another generation, so the old handles are not valid)
+struct EntityHandle {
+    uint32_t id = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// the sprites of a level, stored as an array for each field so moving thousands of entities only touches
+// their positions. The entities are packed (destroying one moves the last one into its place) and the
+// sprites buffer of the shaders has them in the same order. The changes are tracked in blocks of entities,
+// and only the changed blocks are uploaded into the buffer (the consecutive ones in one call).
+class EntityStore {
+public:
+    // entities in each block of the changes
+    static constexpr uint32_t blockSize = 64;
+
+private:
+    struct Slot {
+        // position in the packed arrays
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    // the packed entities
+    std::vector<glm::vec2> positions;
+    std::vector<uint32_t> textures;
+    std::vector<glm::ivec2> divisions;
+    std::vector<float> vMoves;
+    std::vector<uint32_t> flags;
+    std::vector<float> radii;
+    std::vector<uint32_t> ids;
+
+    // the packed position of each id, and the ids of the destroyed entities
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeIds;
+
+    std::vector<uint8_t> changedBlocks;
+    bool changed = false;
+    // increased on every change, uploaded or not
+    uint64_t changes = 0;
+    // the sprites of a range are packed here before uploading them
+    std::vector<Sprite> staging;
+
+    friend class StateSnapshot;
+
+    void markChanged(uint32_t index);
+    void pack(uint32_t start, uint32_t end);
+
+public:
+    EntityStore() = default;
+
+    // radius for the collisions, 0 for the sprites that do not block (see Simulation)
+    EntityHandle create(const Sprite& sprite, float radius = defaultSpriteRadius);
+    void destroy(EntityHandle handle);
+    void clear();
+
+    inline bool valid(EntityHandle handle) const {
+        return handle.id < slots.size() && slots[handle.id].generation == handle.generation && slots[handle.id].index != UINT32_MAX;
+    }
+
+    // position of the entity in the packed arrays and in the sprites buffer, it changes when others are destroyed
+    inline uint32_t indexOf(EntityHandle handle) const {
+        return slots[handle.id].index;
+    }
+
+    void setPosition(EntityHandle handle, glm::vec2 pos);
+    void setTexture(EntityHandle handle, uint32_t texture);
+    void setScale(EntityHandle handle, int32_t uDiv, int32_t vDiv, float vMove);
+    void setFlags(EntityHandle handle, uint32_t value);
+    // the radius is only used by the collisions, it is not uploaded
+    void setRadius(EntityHandle handle, float radius);
+
+    inline size_t size() const {
+        return positions.size();
+    }
+
+    // the packed entity at the index (see indexOf)
+    inline glm::vec2 position(uint32_t index) const {
+        return positions[index];
+    }
+
+    inline float radius(uint32_t index) const {
+        return radii[index];
+    }
+
+    // the handle of the packed entity at the index
+    inline EntityHandle handleAt(uint32_t index) const {
+        return { ids[index], slots[ids[index]].generation };
+    }
+
+    Sprite sprite(uint32_t index) const;
+
+    // changes when an entity is created, destroyed or changed, to know if something computed from them is old
+    inline uint64_t version() const {
+        return changes;
+    }
+
+    // copies the entities of another store (a snapshot), only the blocks that are different are uploaded again
+    void assign(const EntityStore& other);
+    // every entity is uploaded in the next uploadChanges (for another buffer)
+    void markAllChanged();
+    // uploads the changed blocks into the sprites buffer, only the first maxCount entities. The buffer grows
+    // if they do not fit (and then everything is uploaded). Returns the bytes uploaded
+    size_t uploadChanges(Buffer& buffer, uint32_t maxCount = UINT32_MAX);
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <glm/vec2.hpp>
+
+using namespace glm;
+
+// a frame of the stream: the image (RGBA8, rows from the bottom) is split in tiles, and only the tiles that
+// changed since the previous frame are sent, each one compressed with LZ4 (or raw if it does not compress).
+// The values are in the byte order of the machine, the clients run in the same machine.
+struct StreamFrameHeader {
+    char magic[4];
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileSize;
+    uint64_t number;
+    // all the tiles are in the frame (the first frame of a client, or the size has changed)
+    uint32_t keyframe;
+    uint32_t changedTiles;
+    // bytes of the tiles after the header, each tile is its index, its size and its data (uint32, uint32, bytes)
+    uint32_t payloadBytes;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(StreamFrameHeader) == 40, "StreamFrameHeader is sent as it is");
+
+class FrameEncoder {
+public:
+    static constexpr uint32_t tileSize = 32;
+
+private:
+    uvec2 size = { 0, 0 };
+    // the last encoded frame, the tiles are compared against it
+    std::vector<uint8_t> previous;
+    std::vector<uint8_t> tile;
+    uint32_t changedTiles = 0;
+
+public:
+    // writes the header and the changed tiles at the start of output, and returns their size
+    // (the output only grows, so it keeps its memory between frames)
+    size_t encode(const uint8_t* pixels, uvec2 size, uint64_t number, bool keyframe, std::vector<uint8_t>& output);
+
+    inline uint32_t lastChangedTiles() const {
+        return changedTiles;
+    }
+};
+
+class FrameDecoder {
+    uvec2 size = { 0, 0 };
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> tile;
+
+public:
+    // applies the tiles of a frame to the image, returns false if the data is invalid (or the first frame is not a keyframe)
+    bool decode(const StreamFrameHeader& header, const uint8_t* payload);
+
+    inline uvec2 getSize() const {
+        return size;
+    }
+
+    inline const std::vector<uint8_t>& getPixels() const {
+        return pixels;
+    }
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+
+// caps the frame rate and measures the time between polling the input of a frame and its swap (poll-to-swap).
+// It is not the whole input latency: the input also waits for the next tick of the simulation, and the camera
+// drawn is interpolated between the last two ticks, which adds up to two ticks more
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct LatencyStats {
+        double averageMs;
+        double maxMs;
+    };
+
+private:
+    Clock::duration frameDuration;
+    Clock::time_point nextFrame;
+    Clock::time_point inputTime;
+    double latencySumMs = 0.0;
+    double latencyMaxMs = 0.0;
+    uint32_t latencySamples = 0;
+
+public:
+    // a maxFps of 0 disables the cap
+    FramePacer(double maxFps);
+
+    // waits until the next frame can start: sleeps most of the time, and spins the last part
+    // because the sleeps are not precise enough
+    void waitForNextFrame();
+    // the input of the frame has been polled (the start of the poll-to-swap time)
+    void inputSampled();
+    // the frame has been swapped (the end of the poll-to-swap time)
+    void frameSwapped();
+    // returns the poll-to-swap time of the frames swapped since the last call
+    LatencyStats takeLatencyStats();
+};
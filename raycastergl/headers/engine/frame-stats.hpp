@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <utils/time-histogram.hpp>
+#include "simulation.hpp"
+
+// records the durations of each frame in histograms, and prints the percentiles every interval and
+// at the end (the stutter does not show in the average FPS). The results can be written in a file,
+// as CSV or JSON (depending on the extension).
+class FrameStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Section {
+        // time between the end of two swaps, what the player sees
+        Frame,
+        // time to send the commands of the frame
+        Cpu,
+        // time spent in the swap
+        Swap,
+        // time of each tick of the simulation (in its thread)
+        Ticks,
+        SectionCount,
+    };
+
+    static constexpr size_t worstFramesCount = 10;
+
+    struct WorstFrame {
+        double ms;
+        // seconds since the start
+        double time;
+        uint64_t frame;
+    };
+
+    struct SectionSummary {
+        uint64_t count;
+        double meanMs;
+        double p50Ms;
+        double p90Ms;
+        double p99Ms;
+        double maxMs;
+        // seconds since the start when the maximum happened (not known for the ticks)
+        double maxTime;
+    };
+
+    struct Interval {
+        double start;
+        double end;
+        std::array<SectionSummary, SectionCount> sections;
+    };
+
+private:
+    Clock::duration interval;
+    std::string statsFile;
+    Clock::time_point start;
+    Clock::time_point intervalStart;
+    Clock::time_point lastSwapEnd;
+    uint64_t frameNumber = 0;
+    double lastFrame = 0.0;
+
+    std::array<TimeHistogram, SectionCount> intervalHistograms;
+    std::array<TimeHistogram, SectionCount> totalHistograms;
+    std::array<double, SectionCount> intervalMaxTime = {};
+    std::array<double, SectionCount> totalMaxTime = {};
+    // sorted from the worst
+    std::vector<WorstFrame> worstFrames;
+    // only kept to write the file
+    std::vector<Interval> intervals;
+
+    void record(Section section, double ms, double time);
+    Interval summarize(double from, double to, const std::array<TimeHistogram, SectionCount>& histograms, const std::array<double, SectionCount>& maxTimes) const;
+    void finishInterval(Simulation& simulation, Clock::time_point now);
+    bool writeCsv(const Interval& total) const;
+    bool writeJson(const Interval& total) const;
+
+public:
+    // an interval of 0 prints the stats only at the end
+    FrameStats(double intervalSeconds, const std::string& statsFile);
+
+    // the CPU work of the frame goes from cpuStart to swapStart, and the swap from swapStart to swapEnd
+    void frameFinished(Clock::time_point cpuStart, Clock::time_point swapStart, Clock::time_point swapEnd, Simulation& simulation);
+    // time between the last two frames
+    inline double lastFrameMs() const {
+        return lastFrame;
+    }
+
+    // prints the stats of the whole run and writes the stats file
+    void finish(Simulation& simulation);
+};
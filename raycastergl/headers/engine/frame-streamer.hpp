@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <utils/time-histogram.hpp>
+#include <utils/triple-buffer.hpp>
+#include "frame-codec.hpp"
+
+// sends the frames of the game to local clients (remote viewers, thin clients) through a port of localhost
+// or a Unix socket. The render thread gives the frames read back from the GPU through a triple buffer, and
+// the streamer thread encodes them as deltas (see FrameEncoder) and sends them to every client. A slow
+// client makes the streamer skip frames, never the render thread wait.
+class FrameStreamer {
+public:
+    struct Frame {
+        glm::uvec2 size;
+        std::vector<uint8_t> pixels;
+        uint64_t number;
+    };
+
+    struct Stats {
+        TimeHistogram encodeTimes;
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        uint64_t rawBytes = 0;
+        uint64_t changedTiles = 0;
+    };
+
+private:
+    std::string address;
+    double reportInterval;
+    intptr_t listenSocket = -1;
+    std::thread worker;
+    std::atomic<bool> stopping = false;
+    TripleBuffer<Frame> frames;
+    std::mutex newFrameMutex;
+    std::condition_variable newFrameCondition;
+    bool newFrame = false;
+
+    // only used by the streamer thread
+    std::vector<intptr_t> clients;
+    FrameEncoder encoder;
+    std::vector<uint8_t> encoded;
+    Stats intervalStats;
+    Stats totalStats;
+    std::chrono::steady_clock::time_point intervalStart;
+
+    void run();
+    void acceptClients(bool& keyframe);
+    void sendFrame(const Frame& frame, bool keyframe);
+
+public:
+    // the address is a port in localhost, or unix:<path> for a Unix socket. The encode time and the bytes
+    // of the frames are printed every reportInterval seconds (0 to disable) and at the end
+    FrameStreamer(const std::string& address, double reportInterval);
+    ~FrameStreamer();
+
+    FrameStreamer(const FrameStreamer&) = delete;
+    FrameStreamer& operator=(const FrameStreamer&) = delete;
+
+    // opens the socket and starts serving, returns false if the socket cannot be opened
+    bool start();
+
+    // render thread: the slot for the next frame (it keeps the memory of the old frames), and sends it
+    inline Frame& nextFrame() {
+        return frames.writeSlot();
+    }
+    void frameReady();
+};
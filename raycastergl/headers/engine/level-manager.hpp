@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utils/thread-pool.hpp>
+#include "map.hpp"
+#include "potentially-visible-set.hpp"
+
+// owns the current map, and loads the next one in a worker thread while the current one is being played.
+// When the next map is ready, it replaces the current one between two frames (only the texture is created
+// in the render thread), and the memory of the previous map is freed in the worker thread.
+// The potentially visible set of each map is built with the thread pool when the map is loaded, and kept
+// in a cache by path (loading the map again reuses it). When the walls of the current map change, the set
+// is built again in the worker, and the spriteculler gets every entity until it is ready.
+class LevelManager {
+private:
+    std::optional<Map> currentMap;
+    fs::path currentPath;
+    // the texture of the previous map is reused by the next one if it has the same size
+    GpuPool pool;
+    // time to parse the current map and create its texture
+    double currentLoadMs = 0.0;
+    uint32_t loadedMaps = 0;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::deque<std::function<void()>> jobs;
+    bool stopping = false;
+    // the map parsed by the worker, waiting to be swapped (guarded by the mutex)
+    std::optional<Map> preloadedMap;
+    fs::path preloadedPath;
+    double preloadedParseMs = 0.0;
+    bool loading = false;
+
+    ThreadPool threads;
+    // the sets of the maps without changes (guarded by the mutex)
+    std::map<fs::path, std::shared_ptr<const PotentiallyVisibleSet>> visibilityCache;
+    // the current map (by loadedMaps) and the version of its cells of the last set built or requested,
+    // so a map too big for a set is not built again every frame (guarded by the mutex)
+    uint32_t visibilityMap = 0;
+    uint64_t visibilityVersion = 0;
+    // the set built again after a change, waiting to be given to the map (guarded by the mutex)
+    std::shared_ptr<const PotentiallyVisibleSet> rebuiltVisibility;
+    uint32_t rebuiltMap = 0;
+    uint64_t rebuiltVersion = 0;
+
+    // the set of the map from the cache, or built and added to the cache
+    std::shared_ptr<const PotentiallyVisibleSet> visibilityOf(const fs::path& path, const MapGrid& grid);
+    void run();
+    void push(std::function<void()> job);
+
+public:
+    LevelManager();
+    ~LevelManager();
+
+    LevelManager(const LevelManager&) = delete;
+    LevelManager& operator=(const LevelManager&) = delete;
+
+    // loads the map in the calling thread, for the first map
+    bool load(const fs::path& path);
+    // starts loading the map in the worker thread, the current map is used until it is ready
+    void preload(const fs::path& path);
+    // preloads the map after the current one in the maps folder (in alphabetical order)
+    void preloadNext();
+    // if a preloaded map is ready, makes it the current map. Must be called between frames in the
+    // render thread, returns true if the map has changed
+    bool swapIfReady();
+    // if the current map has no potentially visible set (its walls changed), starts building it in the
+    // worker, and gives it to the map when it is ready if the walls have not changed again. Must be called
+    // between frames in the render thread
+    void updateVisibility();
+
+    inline Map& current() {
+        return *currentMap;
+    }
+
+    inline const fs::path& currentMapPath() const {
+        return currentPath;
+    }
+
+    inline double currentMapLoadMs() const {
+        return currentLoadMs;
+    }
+
+    // maps loaded since the start, the first one included
+    inline uint32_t loadedMapsCount() const {
+        return loadedMaps;
+    }
+};
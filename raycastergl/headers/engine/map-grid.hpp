@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <utils/arena.hpp>
+
+// cells of the map stored in 8x8 tiles: the cells around a cell are usually in the same tile (64 bytes,
+// a cache line), so walking the map in any direction touches fewer cache lines than with rows
+// (where a step in x jumps a whole row).
+// the tiles are stored in rows of tiles, and the cells of a tile in rows too.
+class MapGrid {
+public:
+    static constexpr uint32_t tileBits = 3;
+    static constexpr uint32_t tileSize = 1 << tileBits;
+    static constexpr uint32_t tileMask = tileSize - 1;
+    // the biggest side of a map accepted from a file or a snapshot (a 4096x4096 grid takes 16 MiB)
+    static constexpr uint32_t maxSide = 4096;
+
+private:
+    std::vector<uint8_t, ArenaAllocator<uint8_t>> cells;
+    glm::uvec2 gridSize = { 0, 0 };
+    uint32_t tilesY = 0;
+
+public:
+    MapGrid() = default;
+    explicit MapGrid(glm::uvec2 size, Arena* arena = nullptr);
+    // copies the grid into another arena (or into the heap)
+    MapGrid(const MapGrid& o, Arena* arena): cells(o.cells, ArenaAllocator<uint8_t>(arena)), gridSize(o.gridSize), tilesY(o.tilesY) {}
+    // a plain copy would keep the arena of the other grid (which can be destroyed first), the arena must be chosen
+    MapGrid(const MapGrid&) = delete;
+    MapGrid& operator=(const MapGrid&) = delete;
+    MapGrid(MapGrid&&) = default;
+    MapGrid& operator=(MapGrid&&) = default;
+
+    inline size_t index(size_t x, size_t y) const {
+        size_t tile = (x >> tileBits) * tilesY + (y >> tileBits);
+        return (tile << (2 * tileBits)) | ((x & tileMask) << tileBits) | (y & tileMask);
+    }
+
+    inline uint8_t at(size_t x, size_t y) const {
+        return cells[index(x, y)];
+    }
+
+    inline uint8_t& at(size_t x, size_t y) {
+        return cells[index(x, y)];
+    }
+
+    inline glm::uvec2 size() const {
+        return gridSize;
+    }
+
+    // the tiles in memory order, to copy or compare the whole grid at once
+    inline const uint8_t* storage() const {
+        return cells.data();
+    }
+
+    inline uint8_t* storage() {
+        return cells.data();
+    }
+
+    inline size_t storageBytes() const {
+        return cells.size();
+    }
+
+    // position (in tiles) of the tile stored at this index of the storage
+    inline glm::uvec2 tilePosition(size_t tile) const {
+        return { uint32_t(tile / tilesY), uint32_t(tile % tilesY) };
+    }
+
+    // bytes used by a grid of this size (the last tiles are complete)
+    static size_t storageSize(glm::uvec2 size);
+
+    // copies count cells of the row x starting at y (rows of the map are split between tiles)
+    void copyRow(size_t x, size_t y, size_t count, uint8_t* output) const;
+};
@@ -6,29 +6,78 @@
 #include <variant>
 #include <vector>
 #include <glm/vec2.hpp>
-#include "sprite.hpp"
+#include "entity-store.hpp"
+#include "map-grid.hpp"
+#include "potentially-visible-set.hpp"
+#include <opengl/buffer.hpp>
+#include <opengl/gpu-pool.hpp>
+#include <opengl/shader.hpp>
 #include <opengl/texture.hpp>
+#include <utils/arena.hpp>
 
 using namespace glm;
 using namespace std;
 namespace fs = std::filesystem;
 
+// cells of the map in [start, end), with x and y as in Map::at
+struct MapRect {
+    uvec2 start;
+    uvec2 end;
+};
+
 struct Map {
-    uint8_t* data;
+    // the grid and the texture data are allocated together (and freed together). The entities are not: they
+    // grow and shrink while playing, and the arena never frees, so their arrays stay on the heap
+    std::shared_ptr<Arena> arena;
+    MapGrid data;
     uvec2 size;
     std::variant<uint32_t, vec3> floor;
     std::variant<uint32_t, vec3> ceil;
     vec2 initialPos;
     vec2 initialDir;
     vec2 initialPlane;
-    vector<Sprite> sprites;
+    // the sprites, they can be moved, added and removed while playing (they are uploaded before rendering).
+    // Their arrays are on the heap, not in the arena (see above)
+    EntityStore entities;
     std::shared_ptr<Texture> texture;
+    // the texture contents (rows of x), prepared when the map is parsed and uploaded by createTexture()
+    vector<uint8_t, ArenaAllocator<uint8_t>> textureData;
+    // changes not uploaded into the texture yet, and the buffer used to upload them
+    vector<MapRect> dirtyRects = {};
+    std::shared_ptr<Buffer> stagingBuffer = nullptr;
+    // the cells that can be seen from each cell (shared with the cache of LevelManager), it is removed when
+    // the walls change until it is built again. Without it every entity goes to the spriteculler
+    std::shared_ptr<const PotentiallyVisibleSet> visibility = nullptr;
+    // increased on every change of the cells, to know if a set built in the background is still valid
+    uint64_t cellsVersion = 0;
 
-    inline uint8_t& at(size_t x, size_t y) {
-        return data[x * size.x + y];
+    // the map is stored in tiles (see MapGrid), but the texture has rows of x with size.y cells
+    // (the texture is transposed, it is size.y wide and size.x tall)
+    inline uint8_t at(size_t x, size_t y) const {
+        return data.at(x, y);
     }
 
-    void destroy();
+    // changes a cell of the map (the CPU copy), the texture is updated in the next uploadChanges()
+    void set(size_t x, size_t y, uint8_t value);
+    // the cells of the rectangle were changed directly in the grid, they are uploaded in the next uploadChanges()
+    // (and the visibility set is removed)
+    void markChanged(const MapRect& rect);
+    // uploads the changed rectangles of the map into the texture, call it before using the texture
+    void uploadChanges();
+
+    // creates the texture of the map and uploads the data prepared by parse(), the storage of a texture
+    // of the same size (and the staging buffer) are reused from the pool if it has them
+    void createTexture(GpuPool* pool = nullptr);
+    // gives the texture and the staging buffer to the pool (before the map is freed in another thread)
+    void releaseGpuObjects(GpuPool& pool);
+
+    // the features of the map that change how the shaders are compiled (textured or colored floor and ceiling)
+    Shader::Defines shaderDefines() const;
+    // the defines of all the possible maps, to compile every variant of the shaders
+    static vector<Shader::Defines> allShaderDefines();
 
+    // reads the map without using OpenGL, so it can be called from any thread
+    static optional<Map> parse(const fs::path& path);
+    // parses the map and creates its texture
     static optional<Map> load(const fs::path& path);
 };
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utils/time-histogram.hpp>
+#include <utils/triple-buffer.hpp>
+
+// serves the metrics of the engine in the Prometheus text format, with HTTP through a localhost port or
+// a Unix socket. The render thread sends the values once per second through a triple buffer, so it
+// never waits for the exporter thread (or for the clients).
+class MetricsExporter {
+public:
+    enum GpuPass {
+        Raycaster,
+        DepthReducer,
+        SpriteCuller,
+        SpriteCaster,
+        FloorCaster,
+        Drawer,
+        GpuPassCount,
+    };
+
+    struct Sample {
+        // frame time of the last second
+        double frameP50Ms;
+        double frameP90Ms;
+        double frameP99Ms;
+        double frameMaxMs;
+        // since the start
+        uint64_t frames;
+        double frameSumMs;
+        // average of the last second, only if the GPU timestamps were available
+        bool hasGpuPasses;
+        std::array<double, GpuPassCount> gpuPassMs;
+        uint32_t visibleSprites;
+        uint32_t sprites;
+        uint64_t textureBytes;
+        uint64_t bufferBytes;
+        double mapLoadMs;
+        uint32_t mapLoads;
+    };
+
+private:
+    std::string address;
+    intptr_t listenSocket = -1;
+    std::thread worker;
+    std::atomic<bool> stopping = false;
+    TripleBuffer<Sample> samples;
+
+    // only used by the render thread
+    Sample pending = {};
+    TimeHistogram frameTimes;
+    std::array<double, GpuPassCount> gpuPassSums = {};
+    uint32_t gpuPassSamples = 0;
+    std::chrono::steady_clock::time_point lastPublish;
+
+    void run();
+    std::string format(const Sample& sample) const;
+
+public:
+    // the address is a port in localhost, or unix:<path> for a Unix socket
+    explicit MetricsExporter(const std::string& address);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // opens the socket and starts serving, returns false if the socket cannot be opened
+    bool start();
+
+    // render thread: the values of the sample are sent once per second, after a frame
+    void frameFinished(double frameMs);
+    // render thread: GPU time of each pass of a frame (in GpuPass order)
+    void gpuPassesMeasured(const std::vector<double>& passesMs);
+
+    // render thread: values sent with the next frames (the frame and GPU times are filled by the exporter)
+    inline Sample& sample() {
+        return pending;
+    }
+};
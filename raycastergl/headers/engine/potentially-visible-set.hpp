@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <utils/thread-pool.hpp>
+#include "map-grid.hpp"
+
+// the cells that can be seen from each empty cell of a map (the potentially visible set), so the
+// spriteculler can discard the entities hidden by the walls. It is built by casting rays from points along
+// the sides of each cell to every corner of the map border, splitting the angle between two rays while
+// their ends are far apart, so a sightline cannot slip between them. The visible cells are grown by one in
+// every direction (a sprite is as wide as a cell, so it can be seen from a cell next to a visible one). The
+// visible cells of each cell are stored as a bitset compressed in runs, and expanded only when the player
+// changes of cell.
+class PotentiallyVisibleSet {
+public:
+    // bigger maps have no set (the spriteculler checks every entity)
+    static constexpr size_t maxCells = 64 * 64;
+
+private:
+    glm::uvec2 size = { 0, 0 };
+    // lengths of the runs of hidden and visible cells of each cell, one after the other (see visibleFrom)
+    std::vector<uint8_t> runs;
+    // where the runs of each cell start, the walls have no runs
+    std::vector<uint32_t> offsets;
+
+public:
+    // casts the rays in the threads of the pool (or in the calling thread without it), returns nullptr if the
+    // map is too big
+    static std::shared_ptr<const PotentiallyVisibleSet> build(const MapGrid& grid, ThreadPool* pool = nullptr);
+
+    // fills visible with one value for each cell of the map (index x * size.y + y), 1 if it can be seen from
+    // the cell. Returns false if the cell is a wall or outside of the map (and then everything can be seen)
+    bool visibleFrom(glm::ivec2 cell, std::vector<uint8_t>& visible) const;
+
+    inline glm::uvec2 getSize() const {
+        return size;
+    }
+
+    inline size_t bytes() const {
+        return runs.size() + offsets.size() * sizeof(uint32_t);
+    }
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <opengl/buffer.hpp>
+#include <opengl/buffer-geometry.hpp>
+#include <opengl/buffer-readback.hpp>
+#include <opengl/framebuffer.hpp>
+#include <opengl/gpu-timestamps.hpp>
+#include <opengl/shader.hpp>
+#include <opengl/shader-program.hpp>
+#include <opengl/texture.hpp>
+#include "map.hpp"
+#include "simulation.hpp"
+
+using namespace glm;
+
+// the passes of a frame (raycaster, depthreducer, spriteculler, spritecaster, floorcaster and drawer) with
+// their shaders and buffers. The frame is rendered into its own framebuffer, which is shown in the window
+// by the game or read into memory by the programs that embed the engine.
+class Renderer {
+public:
+    struct Options {
+        // see the --ray-refine-step, --sprite-renderer and --draw-distance arguments
+        uint32_t rayRefineStep = 1;
+        bool spriteQuads = false;
+        float drawDistance = 0.0f;
+    };
+
+private:
+    Options options;
+
+    ShaderProgram raycasterDrawProgram;
+    ShaderProgram raycasterComputeProgram;
+    ShaderProgram spritecasterComputeProgram;
+    ShaderProgram spritecullerComputeProgram;
+    ShaderProgram depthreducerComputeProgram;
+    ShaderProgram spriteDrawProgram;
+    // one floorcaster for each kind of map (see Map::shaderDefines), so changing the map does not compile shaders
+    std::map<Shader::Defines, std::unique_ptr<ShaderProgram>> floorcasterPrograms;
+    ShaderProgram* floorcasterComputeProgram = nullptr;
+
+    BufferGeometry screenPlane;
+    Buffer raycastResultBuffer;
+    Buffer depthHierarchyBuffer;
+    Buffer spritecastResultBuffer;
+    Buffer spritecastInputBuffer;
+    Buffer spriteCommandsBuffer;
+    Buffer visibleCellsBuffer;
+    std::optional<Texture> textures;
+    Framebuffer renderTarget;
+    Texture floorImage;
+    uvec2 renderSize = { 0, 0 };
+    uint32_t spriteCount = 0;
+
+    // the cells that can be seen from the cell of the camera (see PotentiallyVisibleSet), uploaded with one bit
+    // for each cell. The spriteculler discards the entities in the other cells, so they are only uploaded again
+    // when the camera changes of cell or the set changes (not when the entities move)
+    std::vector<uint8_t> visibleCells;
+    std::vector<uint32_t> visibleCellBits;
+    std::shared_ptr<const PotentiallyVisibleSet> visibleCellsSet;
+    ivec2 visibleCellsCell = { INT32_MIN, INT32_MIN };
+
+    // optional measurements of the metrics
+    GpuTimestamps* passTimestamps = nullptr;
+    BufferReadback* visibleSpritesReadback = nullptr;
+
+    void passFinished();
+    // uploads the cells that can be seen from the camera if it changed of cell or the set changed
+    void updateVisibleCells(const Map& map, vec2 pos);
+
+public:
+    explicit Renderer(const Options& options);
+
+    Renderer(const Renderer&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+
+    // compiles the shaders and loads the textures (an OpenGL context must be current), returns false if it fails
+    bool load();
+
+    inline uvec2 getRenderSize() const {
+        return renderSize;
+    }
+
+    inline Texture& getTextures() {
+        return *textures;
+    }
+
+    // the frame is in the section of the render size
+    inline Framebuffer& getRenderTarget() {
+        return renderTarget;
+    }
+
+    void setRenderSize(uvec2 size);
+    // sends the floor of the map to the shaders, and all its entities in the next render
+    void setMap(Map& map);
+    // a section for each pass is measured after beginning a frame, and the visible sprites are copied after the drawer
+    void setPassTimestamps(GpuTimestamps* timestamps);
+    void setVisibleSpritesReadback(BufferReadback* readback);
+
+    // renders a frame of the map into the framebuffer, the changed cells are uploaded before
+    void render(Map& map, const Simulation::Camera& camera);
+    // upscales the frame into a section of the window (the rest is not changed)
+    void blitToScreen(ivec2 pos, ivec2 size);
+    // reads the frame as RGBA8 with the rows from the bottom, with a pixel pack buffer bound data is the offset inside it
+    void readPixels(void* data);
+};
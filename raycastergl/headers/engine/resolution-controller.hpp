@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+
+using namespace glm;
+
+// moves the render resolution between the configured bounds to keep the frame time near the target.
+// columns are reduced first (the raycast cost depends on them) and recovered last.
+class ResolutionController {
+    float targetFrameMs;
+    float minScale;
+    vec2 scale = { 1.0f, 1.0f };
+    double averageFrameMs = 0.0;
+    uint32_t samples = 0;
+
+public:
+    ResolutionController(float targetFrameMs, float minScale);
+
+    inline bool isEnabled() const {
+        return targetFrameMs > 0.0f;
+    }
+
+    inline vec2 getScale() const {
+        return scale;
+    }
+
+    // returns true if the scale has changed
+    bool update(double frameMs);
+    uvec2 renderSize(uvec2 screenSize) const;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <utils/time-histogram.hpp>
+#include <utils/triple-buffer.hpp>
+#include "map.hpp"
+#include "spatial-hash.hpp"
+
+// moves the player at a fixed rate in its own thread, so the cost of the simulation does not add to
+// the frame time. The render thread sends the input and reads the camera of the last two ticks
+// (without locks), and interpolates between them for the time of the frame.
+// Without the thread, the ticks are run when the owner asks for them (programs that embed the engine).
+class Simulation {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Camera {
+        glm::vec2 pos;
+        glm::vec2 dir;
+        glm::vec2 plane;
+    };
+
+    struct Input {
+        bool forward;
+        bool backward;
+        bool rotateLeft;
+        bool rotateRight;
+        // sum of all the mouse movements (the simulation uses the difference between ticks)
+        glm::dvec2 mouseTotal;
+    };
+
+    struct Snapshot {
+        Camera previous;
+        Camera current;
+        Clock::time_point tickTime;
+        uint64_t tick;
+        // resetLevel calls done when the snapshot was taken
+        uint32_t level;
+    };
+
+private:
+    Clock::duration tickDuration;
+    std::thread worker;
+    std::atomic<bool> stopping = false;
+
+    TripleBuffer<Input> input;
+    TripleBuffer<Snapshot> snapshots;
+
+    // changes of the level (a new map, or edited cells), they are rare so they go through a lock
+    std::mutex commandsMutex;
+    std::vector<std::function<void()>> commands;
+
+    // duration of each tick, taken by the render thread from time to time
+    std::mutex tickTimesMutex;
+    TimeHistogram tickTimes;
+
+    // only used by the simulation thread
+    MapGrid collisionGrid;
+    // the sprites that block the player, and the ones found near it
+    SpatialHash solidSprites;
+    // the id in solidSprites of each entity (by the id of its handle), SpatialHash::none if it does not block
+    std::vector<uint32_t> solidIds;
+    std::vector<uint32_t> nearbySprites;
+    Camera camera = {};
+    glm::dvec2 lastMouseTotal = { 0, 0 };
+    uint32_t simulatedLevel = 0;
+    uint64_t tickNumber = 0;
+
+    // only used by the render thread
+    Camera levelStart = {};
+    uint32_t levelNumber = 0;
+
+    void run();
+    void tick(Clock::time_point tickTime);
+    void step(float delta, const Input& input);
+    void post(std::function<void()> command);
+    void startLevel(const Map& map, const Camera& start);
+
+public:
+    explicit Simulation(double tickRate, bool threaded = true);
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // places the player at the start of the map (the grid and the sprites are copied for the collisions)
+    void resetLevel(const Map& map);
+    // places the player at the camera of a snapshot, the grid is copied again (with the cells of the snapshot)
+    void restoreLevel(const Map& map, const Camera& camera);
+    // a cell of the map has changed
+    void setCell(size_t x, size_t y, uint8_t value);
+    // an entity of the map was created or moved, or its radius changed (with a radius of 0 it does not block)
+    void setEntity(EntityHandle handle, glm::vec2 pos, float radius);
+    // an entity of the map was destroyed
+    void removeEntity(EntityHandle handle);
+    // moves the player (in the next tick)
+    void setCamera(const Camera& value);
+
+    // without the thread: runs this number of ticks now, with the last input
+    void advance(uint32_t ticks);
+    // camera after the last tick (or the start of the level)
+    Camera latestCamera();
+
+    // render thread: input of this frame
+    void setInput(const Input& value);
+    // render thread: camera at the given time, between the last two ticks
+    Camera cameraAt(Clock::time_point time);
+    // render thread: adds the durations of the ticks since the last call to the histogram
+    void takeTickTimes(TimeHistogram& into);
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cmath>
+#include <stdint.h>
+#include <vector>
+#include <glm/vec2.hpp>
+
+// uniform grid for the entities of the map (sprites, agents...), each one is a circle. The grid is not
+// stored: the cell of an entity is hashed into a bucket, so a map of any size uses memory only for the
+// entities. Each bucket is a list linked through the entities, moving an entity inside its cell only
+// changes its position and moving it to another cell relinks it, without allocations.
+class SpatialHash {
+public:
+    static constexpr uint32_t none = UINT32_MAX;
+
+private:
+    float cellSize;
+    float inverseCellSize;
+    // first entity of each bucket, the count is a power of two
+    std::vector<uint32_t> buckets;
+    uint32_t bucketMask = 0;
+
+    // the entities by id, the removed ids are reused
+    std::vector<glm::vec2> positions;
+    std::vector<float> radii;
+    std::vector<glm::ivec2> cells;
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> previous;
+    std::vector<uint32_t> freeIds;
+    uint32_t count = 0;
+    // the queries look this far around the cells of the query, so the big entities are found too
+    float maxRadius = 0.0f;
+
+    inline glm::ivec2 cellOf(glm::vec2 pos) const {
+        return glm::ivec2(int32_t(std::floor(pos.x * inverseCellSize)), int32_t(std::floor(pos.y * inverseCellSize)));
+    }
+
+    inline uint32_t bucketOf(glm::ivec2 cell) const {
+        return (uint32_t(cell.x) * 73856093u ^ uint32_t(cell.y) * 19349663u) & bucketMask;
+    }
+
+    void link(uint32_t id);
+    void unlink(uint32_t id);
+    void rehash(size_t bucketCount);
+
+public:
+    // cellSize should be around the size of the queries (and bigger than most entities)
+    explicit SpatialHash(float cellSize = 1.0f, size_t expectedEntities = 64);
+
+    // adds an entity and returns its id
+    uint32_t insert(glm::vec2 pos, float radius);
+    // moves an entity, it is relinked only if it changes of cell
+    void move(uint32_t id, glm::vec2 pos);
+    void remove(uint32_t id);
+    void clear();
+
+    // ids of the entities whose circle touches the circle of the query (in no particular order)
+    void queryRadius(glm::vec2 center, float radius, std::vector<uint32_t>& result) const;
+    // the entity with its center nearest to the point, up to maxDistance (none if there is no one)
+    uint32_t nearest(glm::vec2 center, float maxDistance, uint32_t ignore = none) const;
+
+    inline glm::vec2 position(uint32_t id) const {
+        return positions[id];
+    }
+
+    inline float radius(uint32_t id) const {
+        return radii[id];
+    }
+
+    inline size_t size() const {
+        return count;
+    }
+};
@@ -1,7 +1,17 @@
 #pragma once
 
+#include <cstddef>
 #include <glm/vec2.hpp>
 
+// the buffers of the visible sprites start with room for this number of sprites (they grow with the entities),
+// the batch renderer only draws this number of sprites
+static constexpr size_t maxSprites = 100;
+// the sprites with this flag are not drawn (the other flags are free for the game)
+static constexpr uint32_t spriteHidden = 1;
+// radius of the sprites for the collisions when the map does not give one
+static constexpr float defaultSpriteRadius = 0.25f;
+
+// sprite of the map (the sprite struct in res/shaders/include/sprite.glsl)
 struct Sprite {
     float x;
     float y;
@@ -9,8 +19,30 @@ struct Sprite {
     int32_t uDiv;
     int32_t vDiv;
     float vMove;
+    uint32_t flags;
 
     inline operator glm::vec2() {
         return glm::vec2(x, y);
     }
 };
+
+// result of the spritecaster for a visible sprite (the spritedata struct in res/shaders/include/sprite.glsl)
+struct SpriteData {
+    int32_t spriteWidth;
+    int32_t spriteHeight;
+    float transformY;
+    int32_t spriteScreenX;
+    alignas(8) glm::ivec2 drawX;
+    glm::ivec2 drawY;
+    int32_t vMoveScreen;
+    uint32_t texture;
+};
+
+// both structs are stored in std430 blocks, so the C++ layout must be the same
+// (in debug builds, the offsets are also checked against the linked programs)
+static_assert(offsetof(Sprite, texture) == 8 && offsetof(Sprite, vMove) == 20, "Sprite must match the std430 layout of sprite");
+static_assert(offsetof(Sprite, flags) == 24, "Sprite must match the std430 layout of sprite");
+static_assert(sizeof(Sprite) == 28, "Sprite must match the std430 layout of sprite");
+static_assert(offsetof(SpriteData, drawX) == 16 && offsetof(SpriteData, drawY) == 24, "SpriteData must match the std430 layout of spritedata");
+static_assert(offsetof(SpriteData, vMoveScreen) == 32 && offsetof(SpriteData, texture) == 36, "SpriteData must match the std430 layout of spritedata");
+static_assert(sizeof(SpriteData) == 40, "SpriteData must match the std430 layout of spritedata");
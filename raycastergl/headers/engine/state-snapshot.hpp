@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "map.hpp"
+#include "simulation.hpp"
+
+// state of a level that changes while playing (the camera, the cells of the map with their edits and the
+// entities), restored without loading the map again. The cells are kept in pages of the grid storage, and
+// the pages that did not change since the previous snapshot are shared with it (copy on write), so many
+// snapshots of the same level take little memory. The simulation has no random state, so restoring the
+// snapshot and sending the same input gives the same ticks.
+class StateSnapshot {
+public:
+    // 64 tiles of the grid
+    static constexpr size_t pageSize = 4096;
+    using Page = std::array<uint8_t, pageSize>;
+
+private:
+    uvec2 mapSize = { 0, 0 };
+    Simulation::Camera camera = {};
+    // the last page is filled with zeros after the end of the grid
+    std::vector<std::shared_ptr<const Page>> pages;
+    EntityStore entities;
+
+public:
+    // previous can be a snapshot of the same map, the pages that are still the same are shared with it
+    static StateSnapshot take(const Map& map, const Simulation::Camera& camera, const StateSnapshot* previous = nullptr);
+
+    inline const Simulation::Camera& getCamera() const {
+        return camera;
+    }
+
+    // copies only the tiles that are different into the grid (they are uploaded in the next Map::uploadChanges),
+    // and the entities with their handles (only the changed blocks are uploaded). Fails if the map has another size
+    bool restore(Map& map) const;
+
+    // compact binary form: the cells are stored as runs of the same value (most of a map is empty or wall)
+    std::vector<uint8_t> serialize() const;
+    static std::optional<StateSnapshot> deserialize(const uint8_t* data, size_t size);
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdint.h>
+#include <opengl/texture.hpp>
+
+// width and height of the textures (TEX_SIZE in the shaders)
+static constexpr uint32_t textureSize = 64;
+
+// generates the texture array of the walls and sprites from the pngs of the resources
+Texture loadTextures();
+// decodes an image of the resources directly from the mapped file (nullptr if it fails), free it with free()
+uint8_t* loadImage(const char* path, int& width, int& height, int components, int* fileComponents = nullptr);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <utility>
 #include <vector>
 #include "buffer.hpp"
 
@@ -27,6 +28,7 @@ private:
         bool normalized
     ): Buffer(Buffer::ArrayBuffer, data.data(), data.size()), dataType(dataType), internalSize(internalSize), normalized(normalized) {
         dataSize = data.size();
+        setTag("geometry");
     }
 
 public:
@@ -42,7 +44,7 @@ public:
         bool normalized = false
     ): BufferAttribute(std::vector<uint32_t>(data), internalSize, UnsignedInt, normalized) {}
 
-    BufferAttribute(const BufferAttribute& o): Buffer(o) {
+    BufferAttribute(BufferAttribute&& o) noexcept: Buffer(std::move(o)) {
         dataType = o.dataType;
         dataSize = o.dataSize;
         internalSize = o.internalSize;
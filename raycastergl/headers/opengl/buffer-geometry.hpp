@@ -9,11 +9,14 @@ class BufferGeometry {
     std::vector<BufferAttribute> attributes;
 
     void build();
+    void bindVertexArray();
 
 public:
     ~BufferGeometry();
 
-    void setIndices(const BufferAttribute& indices);
-    void addAttribute(const BufferAttribute& attribute);
+    void setIndices(BufferAttribute&& indices);
+    void addAttribute(BufferAttribute&& attribute);
     void draw();
+    void drawInstanced(uint32_t instances);
+    void drawIndirect(Buffer& commands, size_t offset = 0);
 };
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include "buffer.hpp"
+
+typedef struct __GLsync* GLsync;
+
+// reads values written by the GPU without waiting for it: each frame copies them into a different buffer,
+// and they are read when the GPU has finished the copy (some frames later)
+class BufferReadback {
+    static constexpr size_t slotCount = 4;
+
+    size_t size;
+    std::unique_ptr<Buffer> slots[slotCount];
+    GLsync fences[slotCount] = { nullptr };
+    size_t current = 0;
+    size_t pending = 0;
+
+public:
+    BufferReadback(size_t size);
+    ~BufferReadback();
+
+    BufferReadback(const BufferReadback&) = delete;
+    BufferReadback& operator=(const BufferReadback&) = delete;
+
+    // copies size bytes of the source from the offset
+    void copyFrom(Buffer& source, size_t offset);
+    // reads the oldest copy into data if the GPU has finished it, returns false otherwise
+    bool read(void* data);
+};
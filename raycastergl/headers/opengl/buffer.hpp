@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <functional>
 #include <cstring>
+#include <new>
 
 class Buffer {
 public:
@@ -10,6 +11,11 @@ public:
         ArrayBuffer,
         ElementArrayBuffer,
         ShaderStorageBuffer,
+        DispatchIndirectBuffer,
+        DrawIndirectBuffer,
+        PixelUnpackBuffer,
+        PixelPackBuffer,
+        CopyWriteBuffer,
     };
 
     enum Usage {
@@ -29,6 +35,9 @@ private:
     void* data = nullptr;
     Type type;
     Usage usage = StreamCopy;
+    // bytes reserved in the GPU for this buffer, it can be more than the size after a setData
+    size_t allocated = 0;
+    const char* tag = "untagged";
 
     friend class BufferGeometry;
 
@@ -46,36 +55,73 @@ public:
 
     template<typename DataType, size_t size>
     Buffer(Type type, const DataType data[size], Usage usage = StreamCopy): Buffer(type, size * sizeof(DataType), usage) {
-        this->data = malloc(bufferSize);
+        this->data = ::operator new(bufferSize);
         memcpy(this->data, data, bufferSize);
     }
 
     template<typename DataType>
     Buffer(Type type, const DataType* data, size_t count, Usage usage = StaticCopy): Buffer(type, count * sizeof(DataType), usage) {
-        this->data = malloc(bufferSize);
+        this->data = ::operator new(bufferSize);
         memcpy(this->data, data, bufferSize);
     }
 
-    Buffer(const Buffer& o) {
+    // the GL buffer has only one owner
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    Buffer(Buffer&& o) noexcept {
         bufferSize = o.bufferSize;
-        data = nullptr;
+        data = o.data;
         type = o.type;
         usage = o.usage;
-        buffer = 0;
+        allocated = o.allocated;
+        tag = o.tag;
+        buffer = o.buffer;
 
-        if(o.data) {
-            data = malloc(o.bufferSize);
-            memcpy(data, o.data, o.bufferSize);
-        }
+        o.data = nullptr;
+        o.buffer = 0;
+        o.allocated = 0;
     }
 
     ~Buffer();
 
+    // name of the owner in the memory reports (and in the GL debuggers), must be a string literal
+    void setTag(const char* tag);
+
+    inline size_t size() const {
+        return bufferSize;
+    }
+
+    inline size_t capacity() const {
+        return allocated;
+    }
+
+    inline Type getType() const {
+        return type;
+    }
+
     void bind();
+    void bindAs(Type target);
     void bindBase(uint32_t index);
+    // the storage is reused if the data fits in it
     void setData(const void* data, size_t size);
+    void setSubData(size_t offset, const void* data, size_t size);
+    // grows the storage to at least size bytes, for the buffers only written by the GPU (the contents are lost)
+    void reserve(size_t size);
     void mapWritableBuffer(const std::function<void(void*)>& func);
     void mapBuffer(const std::function<void(const void* const)>& func);
+    // maps the first size bytes for writing, the previous contents are discarded (the GPU may still be using them)
+    void mapForOverwrite(size_t size, const std::function<void(void*)>& func);
+    // maps the whole buffer for reading until unmap() is called, the GPU must not write it meanwhile
+    const void* mapForRead();
+    void unmap();
+
+    // copies a section of this buffer into another one, in the GPU
+    void copySubData(Buffer& destination, size_t offset, size_t destinationOffset, size_t size);
+    // reads a section of the buffer, waits for the GPU if the buffer is still being written
+    void getSubData(size_t offset, void* data, size_t size);
+
+    static void unbind(Type target);
 
     void _writeContentsToFile(const char* fileName);
 
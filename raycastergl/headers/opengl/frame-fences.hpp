@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef struct __GLsync* GLsync;
+
+// limits the frames queued in the driver: a fence is inserted after each frame, and the CPU waits
+// for the oldest one when there are too many (0 disables the limit)
+class FrameFences {
+public:
+    static constexpr uint32_t maxFrames = 8;
+
+private:
+    uint32_t maxFramesInFlight;
+    // ring of the fences of the frames in flight (without allocations each frame)
+    GLsync fences[maxFrames] = { nullptr };
+    uint32_t oldest = 0;
+    uint32_t count = 0;
+
+public:
+    // the limit is clamped to maxFrames
+    FrameFences(uint32_t maxFramesInFlight);
+    ~FrameFences();
+
+    FrameFences(const FrameFences&) = delete;
+    FrameFences& operator=(const FrameFences&) = delete;
+
+    // call after the swap, marks the end of the frame commands
+    void frameSubmitted();
+    // blocks until less than maxFramesInFlight frames are being processed by the GPU
+    void waitForFrameSlot();
+};
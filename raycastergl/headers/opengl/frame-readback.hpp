@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+#include <glm/vec2.hpp>
+#include "buffer.hpp"
+#include "framebuffer.hpp"
+
+typedef struct __GLsync* GLsync;
+
+// reads the rendered frames without waiting for the GPU: each frame is copied into a different pixel buffer,
+// and it is read when the GPU has finished the copy (some frames later), like BufferReadback
+class FrameReadback {
+    static constexpr size_t slotCount = 3;
+
+    std::unique_ptr<Buffer> slots[slotCount];
+    glm::uvec2 sizes[slotCount];
+    GLsync fences[slotCount] = { nullptr };
+    size_t current = 0;
+    size_t pending = 0;
+
+public:
+    FrameReadback() = default;
+    ~FrameReadback();
+
+    FrameReadback(const FrameReadback&) = delete;
+    FrameReadback& operator=(const FrameReadback&) = delete;
+
+    // copies the color of the framebuffer (RGBA8, rows from the bottom)
+    void copyFrom(Framebuffer& framebuffer);
+    // reads the oldest copy into pixels if the GPU has finished it, returns false otherwise
+    bool read(std::vector<uint8_t>& pixels, glm::uvec2& size);
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include "texture.hpp"
+
+using namespace glm;
+
+class Framebuffer {
+    uint32_t framebuffer = 0;
+    uint32_t depthRenderbuffer = 0;
+    Texture colorTexture;
+    ivec2 size;
+    // size of the attachments, they are only replaced when the framebuffer grows
+    ivec2 capacity = { 0, 0 };
+
+public:
+    Framebuffer();
+    ~Framebuffer();
+
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator=(const Framebuffer&) = delete;
+
+    inline ivec2 getSize() const {
+        return size;
+    }
+
+    void setTag(const char* tag);
+    void resize(ivec2 size);
+    void bind();
+    void blitToScreen(ivec2 pos, ivec2 size, bool linear = false);
+    // reads the color of the section of the size as RGBA8 (rows from the bottom), with a pixel pack buffer
+    // bound data is the offset inside the buffer
+    void readPixels(void* data);
+
+    static void bindScreen();
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+// registry of the memory reserved in the GPU by every buffer, texture and renderbuffer, with the tag of
+// its owner (the tags must be string literals). Only used from the render thread.
+class GpuMemory {
+public:
+    enum Kind {
+        Buffers,
+        Textures,
+        Renderbuffers,
+        KindCount,
+    };
+
+    struct Usage {
+        const char* tag;
+        size_t bytes[KindCount];
+        uint32_t objects;
+
+        size_t totalBytes() const;
+    };
+
+    // adds the object or updates its size
+    static void track(Kind kind, uint32_t handle, const char* tag, size_t bytes);
+    static void setTag(Kind kind, uint32_t handle, const char* tag);
+    static void untrack(Kind kind, uint32_t handle);
+
+    static size_t totalBytes(Kind kind);
+    // usage of each tag, from the biggest one
+    static std::vector<Usage> usageByTag();
+    static void printReport();
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include "buffer.hpp"
+#include "texture.hpp"
+
+// keeps the buffers and textures that are not used anymore, so a new owner with the same needs reuses
+// their storage instead of deleting it and reserving it again (like the map texture when the level
+// changes). The objects in the pool are tagged as "pool" in the memory reports.
+class GpuPool {
+    static constexpr size_t maxObjects = 4;
+
+    std::deque<std::shared_ptr<Texture>> textures;
+    std::deque<std::shared_ptr<Buffer>> buffers;
+
+public:
+    GpuPool() = default;
+
+    GpuPool(const GpuPool&) = delete;
+    GpuPool& operator=(const GpuPool&) = delete;
+
+    // a 2D texture with exactly this format and size, or nullptr if there is none
+    std::shared_ptr<Texture> acquireTexture2D(Texture::InternalFormat format, ivec2 size, const char* tag);
+    // a buffer of this type with room for the size, or nullptr if there is none
+    std::shared_ptr<Buffer> acquireBuffer(Buffer::Type type, size_t size, const char* tag);
+
+    // the object must not be used by someone else, the oldest objects are deleted when the pool is full
+    void release(std::shared_ptr<Texture> texture);
+    void release(std::shared_ptr<Buffer> buffer);
+};
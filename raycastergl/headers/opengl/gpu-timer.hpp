@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+#include <optional>
+
+// measures the GPU time of a section of commands, the results are read some frames later
+// to not stall the pipeline waiting for them
+class GpuTimer {
+    static constexpr size_t queryCount = 4;
+
+    uint32_t queries[queryCount] = { 0 };
+    size_t current = 0;
+    size_t pending = 0;
+
+public:
+    GpuTimer() = default;
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin();
+    void end();
+    std::optional<double> getElapsedMs();
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+// measures the GPU time of consecutive sections of a frame with timestamps (unlike GpuTimer, they can be
+// used inside the section of a GpuTimer). The results are read some frames later.
+class GpuTimestamps {
+    static constexpr size_t frameCount = 4;
+
+    size_t sectionCount;
+    std::vector<uint32_t> queries;
+    size_t current = 0;
+    size_t pending = 0;
+    size_t nextMark = 0;
+
+public:
+    GpuTimestamps(size_t sectionCount);
+    ~GpuTimestamps();
+
+    GpuTimestamps(const GpuTimestamps&) = delete;
+    GpuTimestamps& operator=(const GpuTimestamps&) = delete;
+
+    // marks the start of the first section
+    void beginFrame();
+    // marks the end of the current section (and the start of the next one)
+    void endSection();
+    // fills the duration of each section of the oldest frame (sectionsMs must have a value for each one),
+    // returns false if its results are not available yet
+    bool getSectionsMs(std::vector<double>& sectionsMs);
+};
@@ -3,8 +3,10 @@
 #include <initializer_list>
 #include <unordered_map>
 #include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include "shader.hpp"
+#include "buffer.hpp"
 
 class ShaderProgram {
 private:
@@ -25,7 +27,13 @@ public:
     void setUniform(const char* name, uint32_t x);
     void setUniform(const char* name, int x, int y);
     void setUniform(const char* name, const glm::vec2& v);
+    void setUniform(const char* name, const glm::vec3& v);
     void setUniform(const char* name, const glm::vec4& v);
+    void setUniform(const char* name, float x);
+
+    // checks the offset and the array stride of a buffer variable (like "res[0].distWall") against the C++ side
+    bool checkBufferLayout(const char* variable, size_t offset, size_t arrayStride) const;
 
     void dispatchCompute(uint32_t x = 1, uint32_t y = 1, uint32_t z = 1);
+    void dispatchComputeIndirect(Buffer& commands, size_t offset = 0);
 };
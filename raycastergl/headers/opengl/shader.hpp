@@ -1,16 +1,29 @@
 #pragma once
 
+#include <map>
 #include <optional>
 #include <filesystem>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 namespace fs = std::filesystem;
 
 class Shader {
+public:
+    // name and value of the #defines inserted after the #version line
+    using Defines = std::map<std::string, std::string>;
+
+private:
     uint32_t shader = 0;
     fs::path path;
+    // files that form the source, the index is the source string number used in #line (and in the errors)
+    std::vector<fs::path> sources;
 
     friend class ShaderProgram;
 
+    bool preprocess(const fs::path& path, std::string& output, std::unordered_set<std::string>& included);
+
 public:
     enum Type {
         Vertex,
@@ -21,12 +34,18 @@ public:
     Shader(Type type);
     ~Shader();
 
-    bool load(const fs::path& path);
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    // resolves the #include "file" (relative to the shaders folder, each file is included once)
+    // and inserts the defines after the #version line
+    bool load(const fs::path& path, const Defines& defines = {});
     bool compile() const;
 
-    bool loadAndCompile(const fs::path& path) {
-        return load(path) && compile();
+    bool loadAndCompile(const fs::path& path, const Defines& defines = {}) {
+        return load(path, defines) && compile();
     }
 
-    static std::optional<Shader> load(const fs::path& path, Type type);
+    // makes the content available for #include "name", for code generated from the C++ side
+    static void addGeneratedInclude(const std::string& name, const std::string& content);
 };
@@ -32,12 +32,14 @@ public:
 
     enum InternalFormat {
         RGBA32F,
+        RGBA8,
         R8UI,
     };
 
     enum ExternalFormat {
         RedInteger,
         RGB,
+        RGBA,
     };
 
     enum DataType {
@@ -46,9 +48,17 @@ public:
 
 private:
     uint32_t texture = 0;
+    Type textureType;
     int type = 0;
     int levels = 1;
     InternalFormat internalFormat;
+    // size of the storage (the first level)
+    ivec3 storageSize = { 0, 0, 0 };
+    const char* tag = "untagged";
+
+    friend class Framebuffer;
+
+    void setStorage(ivec3 size, size_t bytes);
 
     void checkTextureIsBound();
 
@@ -56,24 +66,52 @@ public:
     Texture(Type type);
     ~Texture();
 
-    Texture(const Texture& o) = default;
+    // the GL texture has only one owner
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
 
-    Texture(Texture&& o) {
+    Texture(Texture&& o) noexcept {
         texture = o.texture;
+        textureType = o.textureType;
         type = o.type;
         levels = o.levels;
         internalFormat = o.internalFormat;
+        storageSize = o.storageSize;
+        tag = o.tag;
 
         o.texture = 0;
     }
 
+    // name of the owner in the memory reports (and in the GL debuggers), must be a string literal
+    void setTag(const char* tag);
+
+    inline ivec3 getStorageSize() const {
+        return storageSize;
+    }
+
+    inline InternalFormat getInternalFormat() const {
+        return internalFormat;
+    }
+
+    inline Type getType() const {
+        return textureType;
+    }
+
     void setWrap(Wrap s, Wrap t = Repeat, Wrap r = Repeat);
     void setMinFilter(Filter filter);
     void setMagFilter(Filter filter);
 
     void fillImage2D(int level, InternalFormat iformat, ivec2 size, int border, ExternalFormat eformat, DataType type, const void* data);
+    // reserves an empty image of at least this size, the storage is only replaced when it is smaller
+    // (or has a different format), so the texture can be resized often. Returns true if it was replaced
+    // (the texture must be bound).
+    bool reserveImage2D(InternalFormat format, ivec2 size);
+    // with a pixel unpack buffer bound, data is the offset inside the buffer
+    void fillSubImage2D(int level, ivec2 offset, ivec2 size, ExternalFormat format, DataType type, const void* data);
     void reserveStorage3D(InternalFormat format, ivec3 size, size_t levels = 1);
     void fillSubImage3D(int level, ivec3 offset, ivec3 size, ExternalFormat format, DataType type, const void* data);
+    // reads the whole level (all the layers of an array), waits for the GPU
+    void getImage(int level, ExternalFormat format, DataType type, void* data);
 
     void bind();
     void bindImage(uint32_t index, uint32_t level = 0, bool write = false, std::optional<int> layer = std::nullopt);
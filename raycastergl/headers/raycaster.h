@@ -0,0 +1,110 @@
+#pragma once
+
+/*
+ * C API of the raycaster engine, for programs (and other languages) that embed it.
+ * An engine owns a hidden window with its OpenGL 4.3 context, a map, a camera and a renderer. The functions
+ * of an engine must be called from the thread that created it. The functions that can fail return 0 and
+ * leave the reason in rc_last_error(), the C++ exceptions never leave them (they fail in the same way).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(RAYCASTER_BUILD)
+#    define RC_API __declspec(dllexport)
+#  else
+#    define RC_API __declspec(dllimport)
+#  endif
+#else
+#  define RC_API __attribute__((visibility("default")))
+#endif
+
+/* changes when the functions or the structs change in a way that breaks the programs built with the old ones */
+#define RC_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rc_engine rc_engine;
+typedef struct rc_snapshot rc_snapshot;
+/* an entity of the loaded map, 0 is never a valid one */
+typedef uint64_t rc_entity;
+
+/* flags of the entities, the other bits are free for the program */
+#define RC_ENTITY_HIDDEN 1
+
+typedef struct rc_camera {
+    float position[2];
+    float direction[2];
+    /* the camera plane, perpendicular to the direction (its length is the field of view) */
+    float plane[2];
+} rc_camera;
+
+/* the keys of the game, non zero when pressed */
+typedef struct rc_input {
+    int forward;
+    int backward;
+    int rotate_left;
+    int rotate_right;
+} rc_input;
+
+RC_API int rc_api_version(void);
+
+/* resource_dir is the folder with the shaders, maps and textures (NULL for "res" in the working directory) */
+RC_API rc_engine* rc_create(const char* resource_dir, uint32_t width, uint32_t height);
+RC_API void rc_destroy(rc_engine* engine);
+/* reason of the last failure in this thread, empty if nothing failed */
+RC_API const char* rc_last_error(void);
+
+/*
+ * loads a map of the maps folder (like "default.yaml") and places the camera at its start. The potentially visible
+ * set of the map is built here too, if the cells change (restoring a snapshot) every entity is culled in the GPU
+ */
+RC_API int rc_load_map(rc_engine* engine, const char* name);
+RC_API void rc_get_camera(const rc_engine* engine, rc_camera* camera);
+RC_API void rc_set_camera(rc_engine* engine, const rc_camera* camera);
+/* runs ticks of the simulation (120 per second) with the same input, the camera collides with the walls */
+RC_API void rc_step(rc_engine* engine, const rc_input* input, uint32_t ticks);
+
+/* renders a frame from the camera, and starts copying it to the memory returned by rc_get_framebuffer */
+RC_API int rc_render(rc_engine* engine);
+/*
+ * the last rendered frame as RGBA8, width * height * 4 bytes with the rows from the bottom. The memory belongs
+ * to the engine, it is valid until the next rc_render or rc_destroy (NULL if nothing was rendered).
+ */
+RC_API const void* rc_get_framebuffer(rc_engine* engine, uint32_t* width, uint32_t* height);
+/* copies the last rendered frame into memory of the caller, size must be at least width * height * 4 */
+RC_API int rc_read_framebuffer(rc_engine* engine, void* pixels, size_t size);
+
+/*
+ * the sprites of the map are entities that can be added, moved, animated (changing the texture) and removed.
+ * Only the changed entities are uploaded in the next rc_render. The entity of a handle can be in another
+ * position of the sprites after removing others, but the handle is valid until its entity is removed.
+ * The entities added here do not block the camera.
+ */
+RC_API rc_entity rc_entity_create(rc_engine* engine, float x, float y, uint32_t texture);
+RC_API void rc_entity_destroy(rc_engine* engine, rc_entity entity);
+RC_API uint32_t rc_entity_count(const rc_engine* engine);
+RC_API int rc_entity_set_position(rc_engine* engine, rc_entity entity, float x, float y);
+RC_API int rc_entity_set_texture(rc_engine* engine, rc_entity entity, uint32_t texture);
+/* u_div and v_div divide the size of the sprite, v_move moves it down (up if negative) */
+RC_API int rc_entity_set_scale(rc_engine* engine, rc_entity entity, int32_t u_div, int32_t v_div, float v_move);
+RC_API int rc_entity_set_flags(rc_engine* engine, rc_entity entity, uint32_t flags);
+
+/*
+ * the camera, the cells of the map (with their changes) and the entities. Restoring only copies what changed,
+ * the map is not loaded again. The snapshots of an engine share the parts of the map that are the same.
+ */
+RC_API rc_snapshot* rc_snapshot_take(rc_engine* engine);
+/* the snapshot must be of the loaded map (or at least of a map with the same size) */
+RC_API int rc_snapshot_restore(rc_engine* engine, const rc_snapshot* snapshot);
+RC_API void rc_snapshot_free(rc_snapshot* snapshot);
+/* writes the snapshot into data if size is enough, and returns the size it needs (call it with NULL to know it) */
+RC_API size_t rc_snapshot_serialize(const rc_snapshot* snapshot, void* data, size_t size);
+RC_API rc_snapshot* rc_snapshot_deserialize(const void* data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stdint.h>
+
+// allocations done with operator new in the calling thread since it started (the global operator new
+// is replaced to count them). Used to check that the frames do not allocate.
+uint64_t threadAllocationCount();
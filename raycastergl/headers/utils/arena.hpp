@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <stdint.h>
+#include <type_traits>
+
+// one block of memory for objects that are freed together: allocating only moves a pointer forward,
+// and nothing is freed until the whole arena is destroyed. When the block is full, the allocations
+// go to the heap (and are freed as usual).
+class Arena {
+private:
+    std::unique_ptr<uint8_t[]> memory;
+    size_t capacity;
+    size_t used = 0;
+
+public:
+    explicit Arena(size_t capacity);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t alignment);
+    void deallocate(void* ptr);
+
+    inline bool owns(const void* ptr) const {
+        return ptr >= memory.get() && ptr < memory.get() + capacity;
+    }
+
+    inline size_t usedBytes() const {
+        return used;
+    }
+};
+
+// allocator for the std containers that uses an arena, or the heap if there is no arena
+template<typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    // the containers take the memory (and the arena) of the other when they are moved or assigned
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    Arena* arena = nullptr;
+
+    ArenaAllocator() = default;
+    ArenaAllocator(Arena* arena): arena(arena) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& o): arena(o.arena) {}
+
+    T* allocate(size_t count) {
+        if(arena) {
+            return (T*) arena->allocate(count * sizeof(T), alignof(T));
+        }
+
+        return (T*) ::operator new(count * sizeof(T));
+    }
+
+    void deallocate(T* ptr, size_t) {
+        if(arena) {
+            arena->deallocate(ptr);
+        } else {
+            ::operator delete(ptr);
+        }
+    }
+
+    template<typename U>
+    inline bool operator==(const ArenaAllocator<U>& o) const {
+        return arena == o.arena;
+    }
+
+    template<typename U>
+    inline bool operator!=(const ArenaAllocator<U>& o) const {
+        return arena != o.arena;
+    }
+};
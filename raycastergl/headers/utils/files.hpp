@@ -1,13 +1,49 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 
 struct BinaryData {
     std::shared_ptr<uint8_t[]> data;
     size_t length;
 };
 
+// read-only view of a whole file mapped into memory (the pages are read by the OS when they are used),
+// the file is unmapped when the object is destroyed
+class MappedFile {
+private:
+    const uint8_t* address = nullptr;
+    size_t length = 0;
+
+    MappedFile(const uint8_t* address, size_t length): address(address), length(length) {}
+
+public:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o): address(o.address), length(o.length) {
+        o.address = nullptr;
+        o.length = 0;
+    }
+    ~MappedFile();
+
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& o);
+
+    inline const uint8_t* data() const { return address; }
+    inline size_t size() const { return length; }
+    inline const uint8_t* begin() const { return address; }
+    inline const uint8_t* end() const { return address + length; }
+    inline std::string_view view() const { return std::string_view((const char*) address, length); }
+
+    static std::optional<MappedFile> open(const std::filesystem::path& path);
+};
+
+// the resources (shaders, maps and textures) are in the res folder of the working directory by default,
+// programs that embed the engine can move them (before loading anything, it is not synchronized)
+void setResourceDirectory(const std::filesystem::path& directory);
+std::filesystem::path resourcePath(const std::filesystem::path& relative);
+
 std::optional<std::string> readFile(const std::filesystem::path& path);
-std::optional<BinaryData> readFileBinary(const std::filesystem::path& path);
\ No newline at end of file
+std::optional<BinaryData> readFileBinary(const std::filesystem::path& path);
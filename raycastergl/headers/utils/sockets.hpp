@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+
+// stream sockets of the servers of the engine (metrics and frames) and their clients. The addresses are
+// a port of localhost (not reachable from other machines) or unix:<path> for a Unix socket.
+static constexpr intptr_t invalidSocket = -1;
+
+// opens a socket that accepts connections, what is the name of the server shown in the errors. A Unix socket
+// left by a run that ended is replaced, but not a socket in use or a file that is not a socket
+intptr_t openListenSocket(const std::string& address, const char* what);
+// closes a socket opened with openListenSocket (and removes the file of a Unix socket if it is still its own)
+void closeListenSocket(intptr_t socket, const std::string& address);
+// waits up to timeoutMs for a client, returns invalidSocket if none connects
+intptr_t acceptConnection(intptr_t socket, int timeoutMs);
+
+// connects to a server of the engine, returns invalidSocket if it fails
+intptr_t connectSocket(const std::string& address);
+void closeSocket(intptr_t socket);
+
+// sends and receives fail if the other side waits more than timeoutMs
+void setSocketTimeout(intptr_t socket, int timeoutMs);
+bool sendAll(intptr_t socket, const void* data, size_t size);
+bool receiveAll(intptr_t socket, void* data, size_t size);
+// receives what has arrived (up to size bytes), 0 or less if the connection is closed or fails
+long receiveSome(intptr_t socket, void* data, size_t size);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// threads for the work that can be split in many independent parts (like the rays of the visibility sets).
+// The threads wait for tasks, so the pool can be created once and used for every map.
+class ThreadPool {
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::deque<std::function<void()>> tasks;
+    bool stopping = false;
+
+    void run();
+    void push(std::function<void()> task);
+
+public:
+    // by default, one thread less than the cores (the calling thread works too)
+    explicit ThreadPool(size_t threadCount = defaultThreadCount());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // calls body with every index in [0, count) from the threads of the pool and the calling thread,
+    // and returns when all of them have finished. It can be called from several threads at the same time
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    inline size_t size() const {
+        return threads.size();
+    }
+
+    static size_t defaultThreadCount();
+};
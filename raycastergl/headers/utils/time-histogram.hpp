@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <stdint.h>
+
+// histogram of durations with a fixed size (like HdrHistogram): the values are stored in microseconds,
+// with 64 buckets for each power of two, so the error of any value is below 1.6%. Durations longer
+// than 67 seconds are counted in the last bucket.
+class TimeHistogram {
+    static constexpr uint32_t subBucketBits = 6;
+    static constexpr uint32_t subBucketCount = 1 << subBucketBits;
+    static constexpr uint32_t valueBits = 26;
+
+public:
+    static constexpr size_t bucketCount = (valueBits - subBucketBits + 1) * subBucketCount;
+
+private:
+    std::array<uint32_t, bucketCount> counts = {};
+    uint64_t total = 0;
+    double sumMs = 0.0;
+    double maxMs = 0.0;
+
+public:
+    void record(double ms);
+    void merge(const TimeHistogram& other);
+    void reset();
+
+    // value below which are the given percent of the values (0 to 100)
+    double percentile(double percent) const;
+
+    inline uint64_t count() const {
+        return total;
+    }
+
+    inline double mean() const {
+        return total ? sumMs / total : 0.0;
+    }
+
+    inline double max() const {
+        return maxMs;
+    }
+
+    inline uint32_t valuesIn(size_t bucket) const {
+        return counts[bucket];
+    }
+
+    // the middle of the range of durations of a bucket, in milliseconds
+    static double bucketMs(size_t bucket);
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// passes the latest value from one writer thread to one reader thread without locks: the writer fills
+// its slot and publishes it, and the reader takes the last published slot. Neither of them waits for
+// the other, and old values are skipped if the reader is slower.
+template<typename T>
+class TripleBuffer {
+private:
+    static constexpr uint8_t indexMask = 3;
+    static constexpr uint8_t newDataBit = 4;
+
+    T slots[3] = {};
+    // the slot owned by nobody (with newDataBit if it has a value that the reader has not taken)
+    std::atomic<uint8_t> middle = { 1 };
+    // only used by the writer
+    uint8_t back = 0;
+    // only used by the reader
+    uint8_t front = 2;
+
+public:
+    // writer: the slot to fill, it is not visible to the reader until publish()
+    inline T& writeSlot() {
+        return slots[back];
+    }
+
+    // writer: makes the slot visible to the reader, and takes another one for the next value
+    inline void publish() {
+        back = middle.exchange(back | newDataBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // reader: takes the last published value if there is a new one, returns true if it has changed
+    inline bool update() {
+        if(!(middle.load(std::memory_order_relaxed) & newDataBit)) {
+            return false;
+        }
+
+        front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    // reader: the last value taken with update()
+    inline const T& read() const {
+        return slots[front];
+    }
+};
@@ -0,0 +1,52 @@
+#version 430 core
+
+// Raycaster based on https://lodev.org/cgtutor/raycasting.html
+// this file draws the walls and sprites of many cameras into the batch output, the camera is the z index
+// (the floor and ceiling were already written there by the floorcaster)
+
+#include "column-data.glsl"
+#include "include/sprite.glsl"
+#include "include/batch-output.glsl"
+
+layout(local_size_x=8, local_size_y=8) in;
+layout(std430, binding=2) buffer raycasterOutput {
+    readonly xdata res[];
+};
+layout(std430, binding=3) buffer spritecasterOutput {
+    // spriteCount results for each camera, see spritecaster.glsl
+    readonly spritedata spriteResults[];
+};
+layout(rgba32f, binding=1) uniform image2DArray textures;
+layout(location=1) uniform ivec2 screenSize;
+layout(location=2) uniform uint spriteCount;
+
+#include "include/drawer.glsl"
+
+void main() {
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    uint cameraIndex = gl_GlobalInvocationID.z;
+    if(pixel.x >= screenSize.x || pixel.y >= screenSize.y) {
+        return;
+    }
+
+    xdata data = res[cameraIndex * uint(screenSize.x) + uint(pixel.x)];
+    // the same coordinates as the fragments of raycaster-drawer.glsl
+    float widthf = float(pixel.x) + 0.5f;
+    float heightf = float(pixel.y) + 0.5f;
+
+    vec4 color;
+    bool drawn = wallColor(data, heightf, color);
+    float depth = data.distWall;
+    uint firstSprite = cameraIndex * spriteCount;
+    for(uint spriteNum = 0; spriteNum < spriteCount; spriteNum += 1) {
+        vec4 spritePixel;
+        if(spriteColor(spriteResults[firstSprite + spriteNum], widthf, heightf, depth, spritePixel)) {
+            color = spritePixel;
+            drawn = true;
+        }
+    }
+
+    if(drawn) {
+        storePixel(cameraIndex, pixel, screenSize, color);
+    }
+}
@@ -0,0 +1,43 @@
+#version 430 core
+
+// this file builds a hierarchy with the min and max distance of the walls: the first level has the distance
+// of each column (from the raycaster), and each value of the next levels has the range of two values of
+// the previous level. The last level has only one value, the range of the whole screen.
+
+#include "column-data.glsl"
+
+// the whole hierarchy is built by one group, so the levels can be synchronized with barriers
+layout(local_size_x=1024, local_size_y=1) in;
+layout(std430, binding=2) buffer raycasterOutput {
+    readonly xdata res[10000];
+};
+layout(std430, binding=5) buffer depthHierarchyOutput {
+    // (min, max) of each value, one level after the other
+    restrict vec2 depthRanges[20032];
+};
+layout(location=1) uniform ivec2 screenSize;
+
+void main() {
+    uint local = gl_LocalInvocationID.x;
+    uint count = screenSize.x;
+    for(uint x = local; x < count; x += gl_WorkGroupSize.x) {
+        depthRanges[x] = vec2(res[x].distWall);
+    }
+
+    uint offset = 0;
+    while(count > 1) {
+        memoryBarrierBuffer();
+        barrier();
+
+        uint nextOffset = offset + count;
+        uint nextCount = (count + 1) / 2;
+        for(uint i = local; i < nextCount; i += gl_WorkGroupSize.x) {
+            vec2 left = depthRanges[offset + i * 2];
+            vec2 right = i * 2 + 1 < count ? depthRanges[offset + i * 2 + 1] : left;
+            depthRanges[nextOffset + i] = vec2(min(left.x, right.x), max(left.y, right.y));
+        }
+
+        offset = nextOffset;
+        count = nextCount;
+    }
+}
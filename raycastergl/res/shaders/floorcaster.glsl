@@ -0,0 +1,85 @@
+#version 430 core
+
+// Floor casting based on https://lodev.org/cgtutor/raycasting2.html (horizontal version)
+// this file calculates the floor and ceiling of each row and writes them into an image for the drawer
+
+layout(local_size_x=8, local_size_y=8) in;
+layout(rgba32f, binding=1) uniform image2DArray textures;
+layout(location=4) uniform ivec2 screenSize;
+// BATCH (defined when compiling) casts the floor of many cameras straight into the batch output, the camera
+// is the z index (the drawer only writes the walls and sprites over it)
+#ifdef BATCH
+#include "include/camera.glsl"
+#include "include/batch-output.glsl"
+#else
+layout(rgba8, binding=2) uniform writeonly image2D floorImage;
+layout(location=1) uniform vec2 position;
+layout(location=2) uniform vec2 direction;
+layout(location=3) uniform vec2 plane;
+#endif
+// texture index (FLOOR_TEXTURED / CEIL_TEXTURED defined) or color of the floor and ceiling
+#ifdef FLOOR_TEXTURED
+layout(location=5) uniform uint floorTex;
+#else
+layout(location=5) uniform vec3 floorTex;
+#endif
+#ifdef CEIL_TEXTURED
+layout(location=6) uniform uint ceilTex;
+#else
+layout(location=6) uniform vec3 ceilTex;
+#endif
+
+// pixels of the same row that each instance fills (must match the dispatch size)
+const int spanWidth = 32;
+
+vec4 floorColor(uint tex, vec2 currentFloor) {
+    // coordinates here are Y-inverted !!
+    ivec2 texCoords = ivec2(
+        int(currentFloor.x * TEX_SIZE) % TEX_SIZE,
+        TEX_SIZE - int(currentFloor.y * TEX_SIZE) % TEX_SIZE
+    );
+
+    return imageLoad(textures, ivec3(texCoords, tex));
+}
+
+vec4 floorColor(vec3 color, vec2 currentFloor) {
+    return vec4(color, 1.0f);
+}
+
+void main() {
+    // rows start from the bottom of the screen (OpenGL style), so the floor is the lower half
+    int y = int(gl_GlobalInvocationID.y);
+    int startX = int(gl_GlobalInvocationID.x) * spanWidth;
+    if(y >= screenSize.y / 2 || startX >= screenSize.x) {
+        return;
+    }
+
+#ifdef BATCH
+    uint cameraIndex = gl_GlobalInvocationID.z;
+    camera view = cameras[cameraIndex];
+    vec2 position = view.position;
+    vec2 direction = view.direction;
+    vec2 plane = view.plane;
+#endif
+
+    // distance from the camera to the floor for this row (the same for the mirrored ceiling row)
+    float rowDistance = float(screenSize.y) / (float(screenSize.y) - 2.0f * (float(y) + 0.5f));
+
+    // real world coordinates of the leftmost pixel of the span, and the step to the next pixel
+    vec2 rayDirLeft = direction - plane;
+    vec2 floorStep = rowDistance * 2.0f * plane / float(screenSize.x);
+    vec2 currentFloor = position + rowDistance * rayDirLeft + floorStep * float(startX);
+
+    int endX = min(startX + spanWidth, screenSize.x);
+    int ceilY = screenSize.y - y - 1;
+    for(int x = startX; x < endX; x += 1) {
+#ifdef BATCH
+        storePixel(cameraIndex, ivec2(x, y), screenSize, floorColor(floorTex, currentFloor));
+        storePixel(cameraIndex, ivec2(x, ceilY), screenSize, floorColor(ceilTex, currentFloor));
+#else
+        imageStore(floorImage, ivec2(x, y), floorColor(floorTex, currentFloor));
+        imageStore(floorImage, ivec2(x, ceilY), floorColor(ceilTex, currentFloor));
+#endif
+        currentFloor += floorStep;
+    }
+}
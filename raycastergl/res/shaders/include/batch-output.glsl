@@ -0,0 +1,19 @@
+// output of the batch mode, one image for each camera: the layers of an image array, or (BATCH_TENSOR
+// defined) a packed RGBA8 buffer of [camera][row][column] with the rows from the top of the image
+
+#ifdef BATCH_TENSOR
+layout(std430, binding=7) buffer tensorOutput {
+    writeonly uint pixels[];
+};
+#else
+layout(rgba8, binding=3) uniform writeonly image2DArray layersOutput;
+#endif
+
+void storePixel(uint cameraIndex, ivec2 pixel, ivec2 size, vec4 color) {
+#ifdef BATCH_TENSOR
+    uint row = uint(size.y - 1 - pixel.y);
+    pixels[(cameraIndex * uint(size.y) + row) * uint(size.x) + uint(pixel.x)] = packUnorm4x8(color);
+#else
+    imageStore(layersOutput, ivec3(pixel, cameraIndex), color);
+#endif
+}
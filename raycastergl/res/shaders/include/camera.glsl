@@ -0,0 +1,12 @@
+// cameras of the batch mode, the C++ side is in engine/batch-renderer.hpp
+// (the std430 layout is checked there)
+
+struct camera {
+    vec2 position;
+    vec2 direction;
+    vec2 plane;
+};
+
+layout(std430, binding=6) buffer camerasInput {
+    readonly camera cameras[];
+};
@@ -0,0 +1,55 @@
+// colors of the walls and sprites, shared by raycaster-drawer.glsl and batch-drawer.glsl (the textures
+// image and the screenSize uniform must be declared before including it)
+
+// color of the wall of the column at this height, returns false for the floor and ceiling
+bool wallColor(xdata data, float heightf, out vec4 color) {
+    // the line height and texture step are not stored by the raycaster, they come from the distance
+    int height = screenSize.y;
+    int texHeight = TEX_SIZE;
+    int lineHeight = int(height / data.distWall);
+    // calculate lowest and highest pixel to fill in current stripe
+    ivec2 draw = ivec2(max(-lineHeight / 2 + height / 2, 0), min(lineHeight / 2 + height / 2, height - 1));
+    if(heightf < draw.x || draw.y < heightf) {
+        return false;
+    }
+
+    // how much to increase the texture coordinate per screen pixel
+    float step = float(texHeight) / float(lineHeight);
+    // starting texture coordinate
+    float texPos = float(draw.x - height / 2 + lineHeight / 2) * step + step * (heightf - draw.x);
+    // coordinates here are Y-inverted !!
+    int texY = texHeight - int(texPos) % texHeight;
+
+    color = imageLoad(textures, ivec3(xdataTexX(data), texY, xdataTextureNum(data)));
+
+    // make color darker for y-sides
+    if(xdataSide(data) == 1u) color *= 0.75;
+    return true;
+}
+
+// color of the sprite at this pixel, returns false if it is not there or it is not closer than depth
+// (the sprites are not sorted, so only the closest one is kept: the depth is updated when it is drawn)
+bool spriteColor(spritedata spriteData, float widthf, float heightf, inout float depth, out vec4 color) {
+    bool insideX = spriteData.drawX.x <= widthf && widthf <= spriteData.drawX.y;
+    bool insideY = spriteData.drawY.x <= heightf && heightf <= spriteData.drawY.y;
+    bool validZBuffer = spriteData.transformY > 0 && spriteData.transformY < depth;
+    if(!insideX || !insideY || !validZBuffer) {
+        return false;
+    }
+
+    ivec2 texSize = imageSize(textures).xy;
+    // here I'm using float calculations because is a bit faster
+    int texX = int((widthf - (-spriteData.spriteWidth * 0.5 + spriteData.spriteScreenX)) * texSize.x / spriteData.spriteWidth);
+    int vMoveScreen = spriteData.vMoveScreen;
+    float d = (heightf - vMoveScreen) - screenSize.y * 0.5 + spriteData.spriteHeight * 0.5;
+    int texY = texSize.y - int((d * texSize.y) / spriteData.spriteHeight);
+
+    color = imageLoad(textures, ivec3(texX, texY, spriteData.texture));
+    // i don't know if there is a better way to check if this is black
+    if(length(color.rgb) <= 0.001) {
+        return false;
+    }
+
+    depth = spriteData.transformY;
+    return true;
+}
@@ -0,0 +1,26 @@
+// sprites of the map and the spritecaster results, the C++ side is in engine/sprite.hpp
+// (the std430 layout of both is checked there)
+
+struct sprite {
+    float x;
+    float y;
+    uint texture;
+    int uDiv;
+    int vDiv;
+    float vMove;
+    uint flags;
+};
+
+// same as spriteHidden in engine/sprite.hpp
+#define SPRITE_HIDDEN 1u
+
+struct spritedata {
+    int spriteWidth;
+    int spriteHeight;
+    float transformY;
+    int spriteScreenX;
+    ivec2 drawX;
+    ivec2 drawY;
+    int vMoveScreen;
+    uint texture;
+};
@@ -3,39 +3,49 @@
 // Raycaster based on https://lodev.org/cgtutor/raycasting.html
 // this file only calculates the line heights, which are stored into a shared buffer xD
 
-struct xdata {
-    ivec2 draw;
-    int side;
-    uint textureNum;
-    int texX;
-    float step;
-    float texPos;
-    float distWall;
-    vec2 floorWall;
-};
+#include "column-data.glsl"
 
-layout(local_size_x=1, local_size_y=1) in;
+layout(local_size_x=64, local_size_y=1) in;
 layout(r8ui, binding=1) uniform uimage2D map;
+// BATCH (defined when compiling) casts the columns of many cameras, the camera is the y index of the group
+// and its columns are stored one after the other
+#ifdef BATCH
+#include "include/camera.glsl"
+
+layout(std430, binding=2) buffer dataOutput {
+    restrict xdata res[];
+};
+vec2 position;
+vec2 direction;
+vec2 plane;
+uint columnOffset;
+#else
 layout(std430, binding=2) buffer dataOutput {
     restrict xdata res[10000];
 };
 layout(location=1) uniform vec2 position;
 layout(location=2) uniform vec2 direction;
 layout(location=3) uniform vec2 plane;
+const uint columnOffset = 0u;
+#endif
 layout(location=4) uniform ivec2 screenSize;
 
-void main() {
-    ivec2 pixelCoords = ivec2(gl_GlobalInvocationID.xy);
-    uint x = pixelCoords.x;
-    uint w = screenSize.x;
-    int height = screenSize.y;
-    ivec3 pixel = ivec3(0, 0, 0);
-    ivec2 mapSize = imageSize(map);
+// RAY_REFINE_STEP (defined when compiling) is the number of columns between the sparse rays, 1 means
+// that every column casts its own ray (must divide the group size)
+#if RAY_REFINE_STEP > 1
+// the cell and side hit by the sparse rays of this group
+shared ivec2 sampleMapPos[gl_WorkGroupSize.x + 1];
+shared int sampleSide[gl_WorkGroupSize.x + 1];
+#endif
 
+vec2 rayDirection(uint x) {
     // x-coord in camera space
-    float cameraX = 2 * float(x) / float(w) - 1;
-    vec2 rayDir = direction + plane * cameraX;
+    float cameraX = 2 * float(x) / float(screenSize.x) - 1;
+    return direction + plane * cameraX;
+}
 
+// performs the DDA and returns the map cell hit by the ray, and the side of the hit
+ivec2 castRay(vec2 rayDir, out int side) {
     // where we are now (the box from the map)
     ivec2 mapPos = ivec2(position);
     // length of the ray from one x/y-side to the next x/y-side (simplified formula)
@@ -62,8 +72,9 @@ void main() {
         sideDist.y = (mapPos.y + 1.0f - position.y) * deltaDist.y;
     }
 
-    // perform DDA
-    int side = 0;
+    // perform DDA, the border of the map stops the ray too (an edit can open a hole in the outer walls)
+    ivec2 mapSize = imageSize(map).yx;
+    side = 0;
     bool hit = false;
     while(!hit) {
         if(sideDist.x < sideDist.y) {
@@ -76,11 +87,23 @@ void main() {
             side = 1;
         }
 
+        if(any(lessThan(mapPos, ivec2(0))) || any(greaterThanEqual(mapPos, mapSize))) {
+            break;
+        }
+
         // map coords are reversed!
         uint mapValue = imageLoad(map, mapPos.yx).r;
         hit = mapValue > 0;
     }
 
+    return mapPos;
+}
+
+// calculates the values of the column from the wall hit by its ray, the wall plane is enough so
+// it is possible to use a hit from another ray as long as it is the same cell and side
+void storeColumn(uint x, vec2 rayDir, ivec2 mapPos, int side) {
+    ivec2 step = ivec2(rayDir.x < 0 ? -1 : 1, rayDir.y < 0 ? -1 : 1);
+
     // distance between the camera and the wall (perpendicullar not euclidean)
     float perpWallDist;
     if(side == 0) {
@@ -89,21 +112,9 @@ void main() {
         perpWallDist = (mapPos.y - position.y + (1.0f - step.y) / 2.0f) / rayDir.y;
     }
 
-    // calculate the height of the line to draw
-    int lineHeight = int(height / perpWallDist);
-
-    // calculate lowest and highest pixel to fill in current stripe
-    int drawStart = -lineHeight / 2 + height / 2;
-    if(drawStart < 0) {
-        drawStart = 0;
-    }
-    int drawEnd = lineHeight / 2 + height / 2;
-    if(drawEnd >= height) {
-        drawEnd = height - 1;
-    }
-
-    // texturing calculations (map coords are reversed)
-    uint texNum = imageLoad(map, mapPos.yx).r - 1;
+    // texturing calculations (map coords are reversed), outside of the map it is the first texture
+    uint mapValue = imageLoad(map, mapPos.yx).r;
+    uint texNum = mapValue > 0u ? mapValue - 1u : 0u;
 
     // calculate value of wallX - where exactly the wall was hit
     float wallX;
@@ -115,39 +126,65 @@ void main() {
     wallX -= floor(wallX);
 
     // x coordinate on the texture
-    int texWidth = 64; // TODO not hardcode texWidth and texHeight
-    int texHeight = 64;
+    int texWidth = TEX_SIZE;
     int texX = int(wallX * float(texWidth));
     if(side == 0 && rayDir.x > 0) texX = texWidth - texX - 1;
     if(side == 1 && rayDir.y < 0) texX = texWidth - texX - 1;
 
-    // floow/ceil casting (vertical version to take advantage of this loop)
-    vec2 floorWall;
-
-    // 4 different wall directions possible
-    if(side == 0 && rayDir.x > 0) {
-        floorWall.x = mapPos.x;
-        floorWall.y = mapPos.y + wallX;
-    } else if(side == 0 && rayDir.x < 0) {
-        floorWall.x = mapPos.x + 1.0f;
-        floorWall.y = mapPos.y + wallX;
-    } else if(side == 1 && rayDir.y > 0) {
-        floorWall.x = mapPos.x + wallX;
-        floorWall.y = mapPos.y;
-    } else {
-        floorWall.x = mapPos.x + wallX;
-        floorWall.y = mapPos.y + 1.0f;
+    // store information for the fragment shader (packed, the rest is recalculated from the distance)
+    res[columnOffset + x] = packXdata(uint(side), texNum, uint(texX), perpWallDist); // <- distance is the zbuffer
+}
+
+void main() {
+    uint x = gl_GlobalInvocationID.x;
+    uint w = screenSize.x;
+#ifdef BATCH
+    camera view = cameras[gl_WorkGroupID.y];
+    position = view.position;
+    direction = view.direction;
+    plane = view.plane;
+    columnOffset = gl_WorkGroupID.y * w;
+#endif
+
+#if RAY_REFINE_STEP <= 1
+    if(x < w) {
+        int side;
+        vec2 rayDir = rayDirection(x);
+        ivec2 mapPos = castRay(rayDir, side);
+        storeColumn(x, rayDir, mapPos, side);
+    }
+#else
+    // first, cast one ray every RAY_REFINE_STEP columns (including the first column of the next group)
+    uint local = gl_LocalInvocationID.x;
+    uint groupStart = gl_WorkGroupID.x * gl_WorkGroupSize.x;
+    if(local <= gl_WorkGroupSize.x / RAY_REFINE_STEP) {
+        int side;
+        uint sampleX = min(groupStart + local * RAY_REFINE_STEP, w - 1);
+        sampleMapPos[local] = castRay(rayDirection(sampleX), side);
+        sampleSide[local] = side;
+    }
+
+    memoryBarrierShared();
+    barrier();
+
+    if(x >= w) {
+        return;
     }
 
-    float distWall = perpWallDist;
-
-    // store information for the fragment shader
-    res[x].draw = ivec2(drawStart, drawEnd);
-    res[x].side = side;
-    res[x].textureNum = texNum;
-    res[x].texX = texX;
-    res[x].step = float(texHeight) / float(lineHeight);
-    res[x].texPos = float(drawStart - height / 2 + lineHeight / 2) * res[x].step;
-    res[x].distWall = distWall; // <- zbuffer
-    res[x].floorWall = floorWall;
+    // if the rays at both sides hit the same side of the same cell, this ray hits it too: there
+    // cannot be a wall between them because they are closer than a cell when they reach the wall.
+    // if not, this column casts its own ray
+    uint sampleIndex = local / RAY_REFINE_STEP;
+    vec2 rayDir = rayDirection(x);
+    bool isSample = local % RAY_REFINE_STEP == 0;
+    bool sameWall = sampleMapPos[sampleIndex] == sampleMapPos[sampleIndex + 1]
+        && sampleSide[sampleIndex] == sampleSide[sampleIndex + 1];
+    if(isSample || sameWall) {
+        storeColumn(x, rayDir, sampleMapPos[sampleIndex], sampleSide[sampleIndex]);
+    } else {
+        int side;
+        ivec2 mapPos = castRay(rayDir, side);
+        storeColumn(x, rayDir, mapPos, side);
+    }
+#endif
 }
@@ -0,0 +1,25 @@
+#version 430 core
+
+// Raycaster for sprites based on https://lodev.org/cgtutor/raycasting3.html
+// this file draws the sprite quads, walls and other sprites are hidden by the depth test
+
+out vec4 FragColor;
+
+in vec2 spriteCoord;
+flat in uint spriteTexture;
+
+layout(rgba32f, binding=1) uniform image2DArray textures;
+
+void main() {
+    ivec2 texSize = imageSize(textures).xy;
+    int texX = int(spriteCoord.x * texSize.x);
+    int texY = texSize.y - int(spriteCoord.y * texSize.y);
+
+    vec4 color = imageLoad(textures, ivec3(texX, texY, spriteTexture));
+    // black is transparent, so the depth is not written for these texels
+    if(length(color.rgb) <= 0.001) {
+        discard;
+    }
+
+    FragColor = color;
+}
@@ -0,0 +1,40 @@
+#version 430 core
+
+// Raycaster for sprites based on https://lodev.org/cgtutor/raycasting3.html
+// this file places a quad for each sprite (one instance per sprite) using the spritecaster results
+
+#include "include/sprite.glsl"
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+out vec2 spriteCoord;
+flat out uint spriteTexture;
+
+layout(std430, binding=3) buffer dataOutput {
+    readonly spritedata spriteResults[];
+};
+layout(location=1) uniform ivec2 screenSize;
+
+void main() {
+    spritedata spriteData = spriteResults[gl_InstanceID];
+    spriteCoord = aTexCoord;
+    spriteTexture = spriteData.texture;
+
+    // sprites behind the camera are moved outside the clip volume
+    if(spriteData.transformY <= 0) {
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        return;
+    }
+
+    // same rect the drawer uses, but without clamping it to the screen (Y-inverted too)
+    vec2 start = vec2(
+        -spriteData.spriteWidth * 0.5 + spriteData.spriteScreenX,
+        -spriteData.spriteHeight * 0.5 + screenSize.y * 0.5 + spriteData.vMoveScreen
+    );
+    vec2 pixel = start + aTexCoord * vec2(spriteData.spriteWidth, spriteData.spriteHeight);
+
+    // the depth uses the same mapping as the walls in raycaster-drawer.glsl
+    float depth = spriteData.transformY / (spriteData.transformY + 1.0f);
+    gl_Position = vec4(pixel / vec2(screenSize) * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+}
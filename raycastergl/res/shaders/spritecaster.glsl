@@ -1,44 +1,63 @@
 #version 430 core
 
 // Raycaster for sprites based on https://lodev.org/cgtutor/raycasting3.html
-// this file calculates some values for drawing sprites in the next step
+// this file calculates some values for drawing sprites in the next step, only for the visible sprites
 
-struct spritedata {
-    int spriteWidth;
-    int spriteHeight;
-    float transformY;
-    int spriteScreenX;
-    ivec2 drawX;
-    ivec2 drawY;
-    int vMoveScreen;
-    uint texture;
-};
+#include "include/sprite.glsl"
 
-struct sprite {
-    float x;
-    float y;
-    uint texture;
-    int uDiv;
-    int vDiv;
-    float vMove;
+layout(std430, binding=1) buffer dataInput {
+    restrict sprite sprites[];
 };
+layout(location=4) uniform ivec2 screenSize;
 
-layout(local_size_x=1, local_size_y=1) in;
-layout(std430, binding=1) buffer dataInput {
-    restrict sprite sprites[100];
+// BATCH (defined when compiling) places every sprite for many cameras, the camera is the y index of the
+// group and its results are stored one after the other (the sprites behind it have a negative transformY)
+#ifdef BATCH
+#include "include/camera.glsl"
+
+layout(local_size_x=64, local_size_y=1) in;
+layout(std430, binding=2) buffer dataOutput {
+    restrict spritedata spriteResults[];
 };
+layout(location=5) uniform uint spriteCount;
+#else
+layout(local_size_x=1, local_size_y=1) in;
 layout(std430, binding=2) buffer dataOutput {
-    restrict spritedata spriteResults[100];
+    restrict spritedata spriteResults[];
+};
+layout(std430, binding=4) buffer visibleSpritesInput {
+    // the indirect commands from the spriteculler are before the list
+    readonly uint commands[8];
+    readonly uint visibleSprites[];
 };
 layout(location=1) uniform vec2 position;
 layout(location=2) uniform vec2 direction;
 layout(location=3) uniform vec2 plane;
-layout(location=4) uniform ivec2 screenSize;
+#endif
 
 void main() {
-    ivec2 pixelCoords = ivec2(gl_GlobalInvocationID.xy);
-    uint spriteNum = pixelCoords.x;
-    sprite sprite = sprites[spriteNum];
+#ifdef BATCH
+    uint spriteIndex = gl_GlobalInvocationID.x;
+    if(spriteIndex >= spriteCount) {
+        return;
+    }
+
+    camera view = cameras[gl_WorkGroupID.y];
+    vec2 position = view.position;
+    vec2 direction = view.direction;
+    vec2 plane = view.plane;
+    uint spriteNum = gl_WorkGroupID.y * spriteCount + spriteIndex;
+    sprite sprite = sprites[spriteIndex];
+    if((sprite.flags & SPRITE_HIDDEN) != 0u) {
+        // like the sprites behind the camera
+        spriteResults[spriteNum].transformY = -1.0f;
+        return;
+    }
+#else
+    // the results are stored in the same order as the visible sprites list
+    uint spriteNum = gl_GlobalInvocationID.x;
+    sprite sprite = sprites[visibleSprites[spriteNum]];
+#endif
 
     // translate sprite position to relative to camera
     vec2 spritePos = vec2(sprite.x, sprite.y) - position;
@@ -66,7 +85,8 @@ void main() {
     if(drawY.y >= screenSize.y) drawY.y = screenSize.y - 1;
 
     // calculate width of the sprite on screen
-    int spriteWidth = abs(int(screenSize.y / transform.y)) / sprite.uDiv;
+    //  the screen is 4:3, but the render resolution may not be (the columns are scaled independently)
+    int spriteWidth = abs(int(screenSize.x * 0.75f / transform.y)) / sprite.uDiv;
     ivec2 drawX = ivec2(
         -spriteWidth * 0.5 + spriteScreenX,
         spriteWidth * 0.5 + spriteScreenX
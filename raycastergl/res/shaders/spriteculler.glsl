@@ -0,0 +1,116 @@
+#version 430 core
+
+// this file discards the sprites that cannot be seen (behind the camera, outside the screen, too far or
+// hidden by the walls) and appends the visible ones into a list, the next steps only work with the sprites in this list.
+// The list has room for every sprite (the buffer grows with them). When the map has a potentially visible set,
+// the entities in the cells that cannot be seen from the cell of the camera are discarded first
+
+#include "include/sprite.glsl"
+
+layout(local_size_x=64, local_size_y=1) in;
+layout(std430, binding=1) buffer dataInput {
+    // every entity of the map, the buffer grows with them
+    readonly sprite sprites[];
+};
+layout(std430, binding=4) buffer visibleSpritesOutput {
+    // indirect dispatch for the spritecaster
+    uint dispatchX;
+    uint dispatchY;
+    uint dispatchZ;
+    // indirect (elements) draw for the sprite quads
+    uint drawCount;
+    uint instanceCount;
+    uint drawFirstIndex;
+    int drawBaseVertex;
+    uint drawBaseInstance;
+    // indices of the visible sprites
+    uint visibleSprites[];
+};
+layout(std430, binding=5) buffer depthHierarchyInput {
+    // (min, max) distance of the walls, see depthreducer.glsl
+    readonly vec2 depthRanges[20032];
+};
+layout(std430, binding=6) buffer visibleCellsInput {
+    // one bit for each cell of the map (x * visibleCellsSize.y + y), set if it can be seen from the camera
+    readonly uint visibleCells[];
+};
+layout(location=1) uniform vec2 position;
+layout(location=2) uniform vec2 direction;
+layout(location=3) uniform vec2 plane;
+layout(location=4) uniform ivec2 screenSize;
+layout(location=5) uniform uint spriteCount;
+// 0 means there is no limit
+layout(location=6) uniform float drawDistance;
+// false when the map has no potentially visible set
+layout(location=7) uniform bool useVisibleCells;
+layout(location=8) uniform ivec2 visibleCellsSize;
+
+// returns the maximum distance of the walls between both columns (or something a bit bigger)
+float maxWallDepth(int startX, int endX) {
+    int offset = 0;
+    int count = screenSize.x;
+    // moves up in the hierarchy until the range is covered by two values
+    while(endX - startX > 1) {
+        offset += count;
+        count = (count + 1) / 2;
+        startX /= 2;
+        endX /= 2;
+    }
+
+    return max(depthRanges[offset + startX].y, depthRanges[offset + endX].y);
+}
+
+void main() {
+    if(gl_GlobalInvocationID.x >= spriteCount) {
+        return;
+    }
+
+    uint spriteNum = gl_GlobalInvocationID.x;
+
+    sprite sprite = sprites[spriteNum];
+    if((sprite.flags & SPRITE_HIDDEN) != 0u) {
+        return;
+    }
+
+    // in a cell that cannot be seen from the camera (the entities outside of the map are not in any cell)
+    ivec2 cell = ivec2(floor(vec2(sprite.x, sprite.y)));
+    if(useVisibleCells && all(greaterThanEqual(cell, ivec2(0))) && all(lessThan(cell, visibleCellsSize))) {
+        uint bit = uint(cell.x * visibleCellsSize.y + cell.y);
+        if((visibleCells[bit / 32u] & (1u << (bit % 32u))) == 0u) {
+            return;
+        }
+    }
+
+    // same transformation as in the spritecaster
+    vec2 spritePos = vec2(sprite.x, sprite.y) - position;
+    float invDet = 1.0f / (plane.x * direction.y - direction.x * plane.y);
+    vec2 transform = vec2(
+        invDet * (direction.y * spritePos.x - direction.x * spritePos.y),
+        invDet * (-plane.y * spritePos.x + plane.x * spritePos.y)
+    );
+
+    // behind the camera or too far
+    if(transform.y <= 0.0f || (drawDistance > 0.0f && transform.y > drawDistance)) {
+        return;
+    }
+
+    // outside the screen (left or right)
+    int spriteScreenX = int((screenSize.x * 0.5f) * (1.f + transform.x / transform.y));
+    int spriteWidth = abs(int(screenSize.x * 0.75f / transform.y)) / sprite.uDiv;
+    ivec2 drawX = ivec2(
+        -spriteWidth * 0.5 + spriteScreenX,
+        spriteWidth * 0.5 + spriteScreenX
+    );
+    if(drawX.y < 0 || drawX.x >= screenSize.x) {
+        return;
+    }
+
+    // behind the walls in all its columns
+    if(transform.y >= maxWallDepth(max(drawX.x, 0), min(drawX.y, screenSize.x - 1))) {
+        return;
+    }
+
+    uint index = atomicAdd(dispatchX, 1);
+    atomicAdd(instanceCount, 1);
+    visibleSprites[index] = spriteNum;
+}
@@ -47,6 +47,219 @@ bool Arguments::parseArguments(int argc, const char* const argv[]) {
             }
         })
         .help("Specifies the initial window size (defaults to 1333x1000)");
+    params.add_parameter(spriteRenderer, "--sprite-renderer")
+        .nargs(1)
+        .absent("drawer")
+        .action([] (auto& renderer, const std::string& value, Environment& env) {
+            if(value != "drawer" && value != "quads") {
+                env.add_error("Sprite renderer is invalid (drawer or quads): " + value);
+                return;
+            }
+
+            renderer = value;
+        })
+        .help("Selects how sprites are drawn: drawer loops over all sprites for each pixel, quads draws one quad per sprite with depth testing (defaults to drawer)");
+
+    params.add_parameter(targetFrameMs, "--target-frame-ms")
+        .nargs(1)
+        .absent(0.0f)
+        .action([] (auto& ms, const std::string& value, Environment& env) {
+            ms = std::stof(value);
+            if(ms < 0.0f) {
+                env.add_error("Target frame time is invalid (must be positive or 0): " + value);
+            }
+        })
+        .help("Changes the render resolution to keep the GPU frame time near this value in milliseconds. 0 to always render at the window resolution (defaults to 0)");
+    params.add_parameter(minRenderScale, "--min-render-scale")
+        .nargs(1)
+        .absent(0.5f)
+        .action([] (auto& scale, const std::string& value, Environment& env) {
+            scale = std::stof(value);
+            if(scale <= 0.0f || scale > 1.0f) {
+                env.add_error("Minimum render scale is invalid (above 0 and up to 1): " + value);
+            }
+        })
+        .help("Lowest scale of the window resolution used when --target-frame-ms is set, for both columns and rows (defaults to 0.5)");
+    params.add_parameter(rayRefineStep, "--ray-refine-step")
+        .nargs(1)
+        .absent(1u)
+        .action([] (auto& step, const std::string& value, Environment& env) {
+            step = uint32_t(std::stoul(value));
+            // the raycaster runs in groups of 64 columns, and the step must divide them
+            if(step == 0 || step > 64 || 64 % step != 0) {
+                env.add_error("Ray refine step is invalid (1, 2, 4, 8, 16, 32 or 64): " + value);
+            }
+        })
+        .help("Casts one ray every N columns, and the columns between them only cast their ray if the walls hit at both sides are not the same. The result is the same as casting every column. 1 to cast all columns (defaults to 1)");
+    params.add_parameter(drawDistance, "--draw-distance")
+        .nargs(1)
+        .absent(0.0f)
+        .action([] (auto& distance, const std::string& value, Environment& env) {
+            distance = std::stof(value);
+            if(distance < 0.0f) {
+                env.add_error("Draw distance is invalid (must be positive or 0): " + value);
+            }
+        })
+        .help("Sprites further than this distance are not drawn. 0 to draw all sprites (defaults to 0)");
+    params.add_parameter(tickRate, "--tick-rate")
+        .nargs(1)
+        .absent(120.0)
+        .action([] (auto& rate, const std::string& value, Environment& env) {
+            rate = std::stod(value);
+            if(rate < 1.0 || rate > 1000.0) {
+                env.add_error("Tick rate is invalid (between 1 and 1000): " + value);
+            }
+        })
+        .help("Updates per second of the simulation (player movement), independent of the frame rate (defaults to 120)");
+    params.add_parameter(maxFramesInFlight, "--max-frames-in-flight")
+        .nargs(1)
+        .absent(2)
+        .action([] (auto& frames, const std::string& value, Environment& env) {
+            int number = std::stoi(value);
+            if(number < 0 || number > 8) {
+                env.add_error("Max frames in flight is invalid (between 0 and 8): " + value);
+            }
+            frames = uint32_t(number);
+        })
+        .help("Frames the GPU can have queued before the CPU waits, lower values reduce the input latency (0 uses the driver limit, defaults to 2)");
+    params.add_parameter(maxFps, "--max-fps")
+        .nargs(1)
+        .absent(0.0)
+        .action([] (auto& fps, const std::string& value, Environment& env) {
+            fps = std::stod(value);
+            if(fps < 0.0) {
+                env.add_error("Max FPS is invalid (must be positive): " + value);
+            }
+        })
+        .help("Limits the frame rate, useful without V-Sync (0 to disable, defaults to 0)");
+    params.add_parameter(statsInterval, "--stats-interval")
+        .nargs(1)
+        .absent(10.0)
+        .action([] (auto& interval, const std::string& value, Environment& env) {
+            interval = std::stod(value);
+            if(interval < 0.0) {
+                env.add_error("Stats interval is invalid (must be positive): " + value);
+            }
+        })
+        .help("Seconds between the frame time percentiles printed in the console (0 prints them only at exit, defaults to 10)");
+    params.add_parameter(statsFile, "--stats-file")
+        .nargs(1)
+        .absent("")
+        .help("Writes the frame time stats of each interval into a file at exit, as JSON if it ends with .json or CSV otherwise");
+    params.add_parameter(metrics, "--metrics")
+        .nargs(1)
+        .absent("")
+        .action([] (auto& address, const std::string& value, Environment& env) {
+            address = value;
+            if(value.rfind("unix:", 0) == 0) {
+                return;
+            }
+
+            size_t end = 0;
+            int port = 0;
+            try {
+                port = std::stoi(value, &end);
+            } catch(const std::exception&) {}
+            if(end != value.size() || port < 1 || port > 65535) {
+                env.add_error("Metrics address is invalid (a port or unix:<path>): " + value);
+            }
+        })
+        .help("Serves Prometheus metrics in a port of localhost, or in a Unix socket with unix:<path> (disabled by default)");
+    params.add_parameter(stream, "--stream")
+        .nargs(1)
+        .absent("")
+        .action([] (auto& address, const std::string& value, Environment& env) {
+            address = value;
+            if(value.rfind("unix:", 0) == 0) {
+                return;
+            }
+
+            size_t end = 0;
+            int port = 0;
+            try {
+                port = std::stoi(value, &end);
+            } catch(const std::exception&) {}
+            if(end != value.size() || port < 1 || port > 65535) {
+                env.add_error("Stream address is invalid (a port or unix:<path>): " + value);
+            }
+        })
+        .help("Streams the frames as tile deltas in a port of localhost, or in a Unix socket with unix:<path> (disabled by default)");
+    params.add_parameter(checkAllocations, "--check-allocations")
+        .nargs(1)
+        .absent(0)
+        .action([] (auto& frames, const std::string& value, Environment& env) {
+            int number = std::stoi(value);
+            if(number < 0) {
+                env.add_error("Number of frames to check is invalid (must be positive): " + value);
+            }
+            frames = uint32_t(number);
+        })
+        .help("Runs this number of frames after a warm up and exits, failing if any of them allocates memory in the render thread (only operator new is counted, not malloc, like the drivers and the libraries do)");
+    params.add_parameter(memoryReport, "--memory-report")
+        .nargs(0)
+        .absent(false)
+        .help("Prints the GPU memory used by each owner (buffers, textures and renderbuffers) when the game is loaded and at exit");
+    params.add_parameter(batchCameras, "--batch")
+        .nargs(1)
+        .absent(0)
+        .action([] (auto& cameras, const std::string& value, Environment& env) {
+            int number = std::stoi(value);
+            // the layers of an image array are limited to 2048 in OpenGL 4.3
+            if(number < 0 || number > 2048) {
+                env.add_error("Number of batch cameras is invalid (between 0 and 2048): " + value);
+            }
+            cameras = uint32_t(number);
+        })
+        .help("Renders the views of this number of cameras in the map at once (one dispatch for each pass) and measures the images per second, without opening the game (disabled by default)");
+    params.add_parameter(batchSize, "--batch-size")
+        .nargs(1)
+        .absent({ 160, 120 })
+        .action([] (auto& vec, const std::string& value, Environment& env) {
+            size_t p = value.find_first_of("x,");
+            if(p == std::string::npos) {
+                env.add_error("Batch image size format is invalid: " + value);
+                return;
+            }
+
+            vec.x = std::stoi(value.substr(0, p));
+            vec.y = std::stoi(value.substr(p + 1));
+            // the raycaster output of a camera is limited like the window width
+            if(vec.x < 8 || vec.y < 8 || vec.x > 10000 || vec.y > 10000) {
+                env.add_error("Batch image size is invalid (between 8 and 10000): " + value);
+            }
+        })
+        .help("Size of the image of each camera in the batch mode (defaults to 160x120)");
+    params.add_parameter(batchOutput, "--batch-output")
+        .nargs(1)
+        .absent("layers")
+        .action([] (auto& output, const std::string& value, Environment& env) {
+            if(value != "layers" && value != "tensor") {
+                env.add_error("Batch output is invalid (layers or tensor): " + value);
+                return;
+            }
+
+            output = value;
+        })
+        .help("Where the batch mode stores the images: layers of an image array, or a tightly packed RGBA8 tensor buffer (defaults to layers)");
+    params.add_parameter(batchFrames, "--batch-frames")
+        .nargs(1)
+        .absent(200)
+        .action([] (auto& frames, const std::string& value, Environment& env) {
+            int number = std::stoi(value);
+            if(number < 1) {
+                env.add_error("Number of batch frames is invalid (must be positive): " + value);
+            }
+            frames = uint32_t(number);
+        })
+        .help("Batches measured for each number of cameras in the batch mode (defaults to 200)");
+    params.add_parameter(benchmarkMapLayout, "--benchmark-map-layout")
+        .nargs(0)
+        .absent(false)
+        .help("Measures random rays over a 4096x4096 map stored by rows and in tiles, and exits");
+    params.add_parameter(benchmarkEntityQueries, "--benchmark-entity-queries")
+        .nargs(0)
+        .absent(false)
+        .help("Measures the collisions and the queries of 100000 moving entities in a spatial hash, and exits");
 
     return parser.parse_args(argc, (char**) (void*) argv, 1);
 }
@@ -0,0 +1,77 @@
+#include <benchmarks/batch-rendering.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// batches before measuring each size (shaders, caches and clocks warm up)
+static constexpr uint32_t warmupBatches = 10;
+
+static vec2 rotate(vec2 v, float angle) {
+    return vec2(v.x * std::cos(angle) - v.y * std::sin(angle), v.x * std::sin(angle) + v.y * std::cos(angle));
+}
+
+int runBatchRenderingBenchmark(BatchRenderer& renderer, Map& map, Texture& textures, uint32_t batches) {
+    const uint32_t maxCameras = renderer.getMaxCameras();
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    // each camera is in the center of a random empty cell (the start of the player if none is found), with the
+    // initial direction and plane of the map rotated by a random angle, and turns slowly at its own speed
+    std::vector<BatchCamera> cameras(maxCameras);
+    std::vector<float> turnSpeeds(maxCameras);
+    for(uint32_t i = 0; i < maxCameras; i += 1) {
+        uvec2 cell;
+        uint32_t attempts = 0;
+        do {
+            cell = uvec2(uint32_t(unit(random) * map.size.x), uint32_t(unit(random) * map.size.y));
+            attempts += 1;
+        } while(map.at(cell.x, cell.y) != 0 && attempts < 1000);
+        if(map.at(cell.x, cell.y) != 0) {
+            cell = uvec2(map.initialPos);
+        }
+
+        const float angle = unit(random) * 2.0f * float(M_PI);
+        cameras[i] = { vec2(cell) + vec2(0.5f, 0.5f), rotate(map.initialDir, angle), rotate(map.initialPlane, angle) };
+        turnSpeeds[i] = (unit(random) - 0.5f) * 0.1f;
+    }
+
+    std::cout << "> Rendering " << batches << " batches of each size, reading the images after each one" << std::endl;
+    std::vector<uint8_t> pixels;
+    double singleCameraMs = 0.0;
+    for(uint32_t count = 1; count <= maxCameras; count = count == maxCameras ? count + 1 : std::min(count * 2, maxCameras)) {
+        std::chrono::steady_clock::time_point start;
+        for(uint32_t batch = 0; batch < warmupBatches + batches; batch += 1) {
+            if(batch == warmupBatches) {
+                start = std::chrono::steady_clock::now();
+            }
+
+            for(uint32_t i = 0; i < count; i += 1) {
+                cameras[i].direction = rotate(cameras[i].direction, turnSpeeds[i]);
+                cameras[i].plane = rotate(cameras[i].plane, turnSpeeds[i]);
+            }
+
+            renderer.render(map, textures, cameras.data(), count);
+            renderer.readImages(pixels, count);
+        }
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        const double batchMs = elapsed.count() / batches;
+        if(count == 1) {
+            singleCameraMs = batchMs;
+        }
+
+        printf(
+            "  %5u cameras %9.3f ms/batch  %10.0f images/s  (%.2fx the images/s of one camera)\n",
+            count,
+            batchMs,
+            count * 1000.0 / batchMs,
+            count * singleCameraMs / batchMs
+        );
+        fflush(stdout);
+    }
+
+    return 0;
+}
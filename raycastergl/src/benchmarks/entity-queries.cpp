@@ -0,0 +1,182 @@
+#include <benchmarks/entity-queries.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <engine/collision.hpp>
+#include <engine/map-grid.hpp>
+#include <engine/spatial-hash.hpp>
+
+// each pass is run this number of times (the best one is shown)
+static constexpr uint32_t runs = 5;
+// one entity every 10 cells, with some walls in the way
+static constexpr uint32_t cellsPerEntity = 10;
+static constexpr float wallProbability = 0.05f;
+// units per move, and size of the queries
+static constexpr float speed = 0.05f;
+static constexpr float queryRadius = 2.0f;
+static constexpr float nearestDistance = 8.0f;
+// queries checked against every entity (it is slow)
+static constexpr uint32_t checkedQueries = 1000;
+
+template<typename Pass>
+static double measure(const char* name, size_t operations, Pass&& pass) {
+    double bestMs = INFINITY;
+    uint64_t result = 0;
+    for(uint32_t run = 0; run < runs; run += 1) {
+        auto start = std::chrono::steady_clock::now();
+        result = pass();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        bestMs = std::min(bestMs, elapsed.count());
+    }
+
+    printf(
+        "  %-14s %9.2f ms  %8.1f ns/op  (%zu ops, %llu results)\n",
+        name,
+        bestMs,
+        bestMs * 1e6 / double(operations),
+        operations,
+        (unsigned long long) result
+    );
+    return bestMs;
+}
+
+int runEntityQueriesBenchmark(uint32_t entityCount) {
+    const uint32_t mapSize = uint32_t(std::ceil(std::sqrt(double(entityCount) * cellsPerEntity)));
+    std::cout << "> Generating " << mapSize << "x" << mapSize << " map with " << entityCount << " entities" << std::endl;
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    MapGrid grid({ mapSize, mapSize });
+    for(uint32_t x = 0; x < mapSize; x += 1) {
+        for(uint32_t y = 0; y < mapSize; y += 1) {
+            grid.at(x, y) = unit(random) < wallProbability ? 1 : 0;
+        }
+    }
+
+    // in the center of free cells, with random sizes and directions
+    std::vector<glm::vec2> positions(entityCount);
+    std::vector<glm::vec2> velocities(entityCount);
+    std::vector<float> radii(entityCount);
+    for(uint32_t i = 0; i < entityCount; i += 1) {
+        uint32_t x, y;
+        do {
+            x = uint32_t(unit(random) * mapSize) % mapSize;
+            y = uint32_t(unit(random) * mapSize) % mapSize;
+        } while(grid.at(x, y) != 0);
+
+        const float angle = unit(random) * 2.0f * float(M_PI);
+        positions[i] = glm::vec2(x + 0.5f, y + 0.5f);
+        velocities[i] = glm::vec2(std::cos(angle), std::sin(angle)) * speed;
+        radii[i] = 0.1f + unit(random) * 0.2f;
+    }
+
+    std::cout << "> Running each pass " << runs << " times (the best one is shown)" << std::endl;
+    SpatialHash entities;
+    measure("insert", entityCount, [&] () {
+        entities.clear();
+        for(uint32_t i = 0; i < entityCount; i += 1) {
+            entities.insert(positions[i], radii[i]);
+        }
+        return uint64_t(entities.size());
+    });
+
+    measure("move + walls", entityCount, [&] () {
+        uint64_t blocked = 0;
+        for(uint32_t id = 0; id < entityCount; id += 1) {
+            const glm::vec2 from = entities.position(id);
+            const glm::vec2 to = moveCircle(grid, from, velocities[id], entities.radius(id));
+            // the entities that hit a wall bounce back
+            if(std::abs(to.x - from.x - velocities[id].x) + std::abs(to.y - from.y - velocities[id].y) > 0.0001f) {
+                velocities[id] = -velocities[id];
+                blocked += 1;
+            }
+            entities.move(id, to);
+        }
+        return blocked;
+    });
+
+    measure("separate", entityCount, [&] () {
+        std::vector<uint32_t> nearby;
+        uint64_t pushed = 0;
+        for(uint32_t id = 0; id < entityCount; id += 1) {
+            const glm::vec2 from = entities.position(id);
+            const glm::vec2 to = separateCircle(entities, from, entities.radius(id), nearby, id);
+            if(to != from) {
+                entities.move(id, to);
+                pushed += 1;
+            }
+        }
+        return pushed;
+    });
+
+    std::vector<uint32_t> found;
+    measure("radius", entityCount, [&] () {
+        uint64_t total = 0;
+        for(uint32_t id = 0; id < entityCount; id += 1) {
+            entities.queryRadius(entities.position(id), queryRadius, found);
+            total += found.size();
+        }
+        return total;
+    });
+
+    measure("nearest", entityCount, [&] () {
+        uint64_t total = 0;
+        for(uint32_t id = 0; id < entityCount; id += 1) {
+            total += entities.nearest(entities.position(id), nearestDistance, id) != SpatialHash::none ? 1 : 0;
+        }
+        return total;
+    });
+
+    // the same queries, testing every entity
+    const uint32_t checked = std::min(checkedQueries, entityCount);
+    std::vector<uint64_t> expected(checked);
+    measure("radius (all)", checked, [&] () {
+        uint64_t total = 0;
+        for(uint32_t query = 0; query < checked; query += 1) {
+            const glm::vec2 center = entities.position(query);
+            uint64_t count = 0;
+            for(uint32_t id = 0; id < entityCount; id += 1) {
+                const glm::vec2 distance = entities.position(id) - center;
+                const float reach = queryRadius + entities.radius(id);
+                count += distance.x * distance.x + distance.y * distance.y <= reach * reach ? 1 : 0;
+            }
+            expected[query] = count;
+            total += count;
+        }
+        return total;
+    });
+
+    for(uint32_t query = 0; query < checked; query += 1) {
+        entities.queryRadius(entities.position(query), queryRadius, found);
+        if(found.size() != expected[query]) {
+            std::cerr << "  The radius query of entity " << query << " found " << found.size()
+                << " entities, but there are " << expected[query] << std::endl;
+            return 1;
+        }
+
+        // two entities can be at the same distance, so only the distances are compared
+        const auto distanceTo = [&] (uint32_t id) {
+            const glm::vec2 distance = entities.position(id) - entities.position(query);
+            return std::sqrt(distance.x * distance.x + distance.y * distance.y);
+        };
+        const uint32_t nearest = entities.nearest(entities.position(query), nearestDistance, query);
+        const float nearestFound = nearest != SpatialHash::none ? distanceTo(nearest) : INFINITY;
+        float nearestExpected = INFINITY;
+        for(uint32_t id = 0; id < entityCount; id += 1) {
+            if(id != query && distanceTo(id) < std::min(nearestExpected, nearestDistance)) {
+                nearestExpected = distanceTo(id);
+            }
+        }
+        if(nearestFound != nearestExpected && std::abs(nearestFound - nearestExpected) > 0.0001f) {
+            std::cerr << "  The nearest entity to entity " << query << " is at " << nearestExpected
+                << ", but the query found one at " << nearestFound << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "> The queries of " << checked << " entities match testing every entity" << std::endl;
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <benchmarks/map-layout.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <engine/map-grid.hpp>
+
+// number of rays of each run, and runs of each layout (the best one is shown)
+static constexpr uint32_t rayCount = 200000;
+static constexpr uint32_t runs = 5;
+// cells that are walls, low so the rays go far
+static constexpr float wallProbability = 0.002f;
+
+struct RowMajorGrid {
+    std::vector<uint8_t> cells;
+    uint32_t sizeY;
+
+    inline uint8_t at(size_t x, size_t y) const {
+        return cells[x * sizeY + y];
+    }
+};
+
+struct Ray {
+    float x;
+    float y;
+    float dirX;
+    float dirY;
+};
+
+// same DDA as the raycaster shader, returns the number of cells visited
+template<typename Grid>
+static uint64_t castRay(const Grid& grid, uint32_t mapSize, const Ray& ray, uint64_t& hits) {
+    int mapX = int(ray.x), mapY = int(ray.y);
+    float deltaDistX = std::abs(1.0f / ray.dirX);
+    float deltaDistY = std::abs(1.0f / ray.dirY);
+    int stepX = ray.dirX < 0 ? -1 : 1;
+    int stepY = ray.dirY < 0 ? -1 : 1;
+    float sideDistX = ray.dirX < 0 ? (ray.x - mapX) * deltaDistX : (mapX + 1.0f - ray.x) * deltaDistX;
+    float sideDistY = ray.dirY < 0 ? (ray.y - mapY) * deltaDistY : (mapY + 1.0f - ray.y) * deltaDistY;
+
+    uint64_t steps = 0;
+    while(true) {
+        if(sideDistX < sideDistY) {
+            sideDistX += deltaDistX;
+            mapX += stepX;
+        } else {
+            sideDistY += deltaDistY;
+            mapY += stepY;
+        }
+
+        steps += 1;
+        if(mapX < 0 || mapY < 0 || uint32_t(mapX) >= mapSize || uint32_t(mapY) >= mapSize) {
+            return steps;
+        }
+
+        if(grid.at(mapX, mapY) != 0) {
+            hits += 1;
+            return steps;
+        }
+    }
+}
+
+template<typename Grid>
+static void runLayout(const char* name, const Grid& grid, uint32_t mapSize, const std::vector<Ray>& rays) {
+    double bestMs = INFINITY;
+    uint64_t steps = 0, hits = 0;
+    for(uint32_t run = 0; run < runs; run += 1) {
+        steps = 0;
+        hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for(const auto& ray : rays) {
+            steps += castRay(grid, mapSize, ray, hits);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        bestMs = std::min(bestMs, elapsed.count());
+    }
+
+    printf(
+        "  %-10s %9.2f ms  %7.2f ns/cell  (%llu cells, %llu hits)\n",
+        name,
+        bestMs,
+        bestMs * 1e6 / double(steps),
+        (unsigned long long) steps,
+        (unsigned long long) hits
+    );
+}
+
+int runMapLayoutBenchmark(uint32_t mapSize) {
+    std::cout << "> Generating " << mapSize << "x" << mapSize << " map" << std::endl;
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    RowMajorGrid rows { std::vector<uint8_t>(size_t(mapSize) * mapSize, 0), mapSize };
+    MapGrid tiles({ mapSize, mapSize });
+    for(uint32_t x = 0; x < mapSize; x += 1) {
+        for(uint32_t y = 0; y < mapSize; y += 1) {
+            uint8_t value = unit(random) < wallProbability ? 1 : 0;
+            rows.cells[size_t(x) * mapSize + y] = value;
+            tiles.at(x, y) = value;
+        }
+    }
+
+    std::vector<Ray> rays(rayCount);
+    for(auto& ray : rays) {
+        float angle = unit(random) * 2.0f * float(M_PI);
+        ray = { unit(random) * mapSize, unit(random) * mapSize, std::cos(angle), std::sin(angle) };
+    }
+
+    std::cout << "> Casting " << rayCount << " rays in random directions (best of " << runs << " runs)" << std::endl;
+    runLayout("rows", rows, mapSize, rays);
+    runLayout("8x8 tiles", tiles, mapSize, rays);
+    return 0;
+}
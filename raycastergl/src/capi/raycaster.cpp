@@ -0,0 +1,444 @@
+#include <raycaster.h>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <string>
+#include <engine/map.hpp>
+#include <engine/renderer.hpp>
+#include <engine/simulation.hpp>
+#include <engine/state-snapshot.hpp>
+#include <opengl/buffer.hpp>
+#include <utils/files.hpp>
+
+// the same tick rate as the game (see --tick-rate)
+static constexpr double tickRate = 120.0;
+
+static thread_local std::string lastError;
+// glfwInit and glfwTerminate are called by the first and last engines
+static uint32_t enginesCount = 0;
+
+struct rc_snapshot {
+    StateSnapshot state;
+};
+
+struct rc_engine {
+    GLFWwindow* window = nullptr;
+    std::optional<Renderer> renderer;
+    std::optional<Map> map;
+    Simulation simulation { tickRate, false };
+    Simulation::Camera camera = {};
+    // the next snapshot shares the pages that did not change with the last one
+    std::optional<StateSnapshot> lastSnapshot;
+
+    // the frame is copied into this buffer after rendering it, and it stays mapped until the next frame
+    std::optional<Buffer> frameBuffer;
+    uvec2 frameSize = { 0, 0 };
+    const void* mappedFrame = nullptr;
+
+    ~rc_engine() {
+        if(window) {
+            glfwMakeContextCurrent(window);
+            if(mappedFrame) {
+                frameBuffer->unmap();
+            }
+
+            // the GL objects are deleted while the context exists
+            frameBuffer.reset();
+            map.reset();
+            renderer.reset();
+            glfwDestroyWindow(window);
+        }
+
+        enginesCount -= 1;
+        if(enginesCount == 0) {
+            glfwTerminate();
+        }
+    }
+
+    void makeCurrent() {
+        if(glfwGetCurrentContext() != window) {
+            glfwMakeContextCurrent(window);
+        }
+    }
+};
+
+static void setError(std::string message) {
+    lastError = std::move(message);
+}
+
+// the exceptions cannot go through the C callers, they become the last error and the failure value
+template<typename Result, typename Body>
+static Result guarded(Result failure, Body&& body) {
+    try {
+        return body();
+    } catch(const std::exception& e) {
+        setError(std::string("unexpected error: ") + e.what());
+    } catch(...) {
+        setError("unexpected error");
+    }
+    return failure;
+}
+
+template<typename Body>
+static void guarded(Body&& body) {
+    try {
+        body();
+    } catch(const std::exception& e) {
+        setError(std::string("unexpected error: ") + e.what());
+    } catch(...) {
+        setError("unexpected error");
+    }
+}
+
+int rc_api_version(void) {
+    return RC_API_VERSION;
+}
+
+rc_engine* rc_create(const char* resource_dir, uint32_t width, uint32_t height) {
+    return guarded<rc_engine*>(nullptr, [&] () -> rc_engine* {
+        if(width == 0 || height == 0) {
+            setError("the size of the frame cannot be empty");
+            return nullptr;
+        }
+
+        if(enginesCount == 0) {
+            glfwSetErrorCallback([] (int, const char* message) {
+                setError(std::string("GLFW: ") + message);
+            });
+            if(!glfwInit()) {
+                return nullptr;
+            }
+        }
+
+        auto engine = std::make_unique<rc_engine>();
+        enginesCount += 1;
+
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        // the frames are only read back, the window is never shown
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        engine->window = glfwCreateWindow(1, 1, "raycaster", nullptr, nullptr);
+        if(engine->window == nullptr) {
+            return nullptr;
+        }
+
+        glfwMakeContextCurrent(engine->window);
+        if(!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+            setError("could not load the OpenGL functions");
+            return nullptr;
+        }
+
+        if(resource_dir) {
+            setResourceDirectory(resource_dir);
+        }
+
+        engine->renderer.emplace(Renderer::Options {});
+        if(!engine->renderer->load()) {
+            setError("could not load the shaders or the textures (the reason is in the standard error)");
+            return nullptr;
+        }
+
+        engine->renderer->setRenderSize({ width, height });
+        return engine.release();
+    });
+}
+
+void rc_destroy(rc_engine* engine) {
+    delete engine;
+}
+
+const char* rc_last_error(void) {
+    return lastError.c_str();
+}
+
+int rc_load_map(rc_engine* engine, const char* name) {
+    return guarded<int>(0, [&] () -> int {
+        engine->makeCurrent();
+        auto map = Map::load(name);
+        if(map == std::nullopt) {
+            setError(std::string("could not load the map ") + name + " (the reason is in the standard error)");
+            return 0;
+        }
+
+        map->visibility = PotentiallyVisibleSet::build(map->data);
+        engine->map = std::move(map);
+        engine->lastSnapshot.reset();
+        engine->renderer->setMap(*engine->map);
+        engine->simulation.resetLevel(*engine->map);
+        engine->camera = engine->simulation.latestCamera();
+        return 1;
+    });
+}
+
+void rc_get_camera(const rc_engine* engine, rc_camera* camera) {
+    const auto& value = engine->camera;
+    camera->position[0] = value.pos.x;
+    camera->position[1] = value.pos.y;
+    camera->direction[0] = value.dir.x;
+    camera->direction[1] = value.dir.y;
+    camera->plane[0] = value.plane.x;
+    camera->plane[1] = value.plane.y;
+}
+
+void rc_set_camera(rc_engine* engine, const rc_camera* camera) {
+    guarded([&] () {
+        engine->camera = {
+            { camera->position[0], camera->position[1] },
+            { camera->direction[0], camera->direction[1] },
+            { camera->plane[0], camera->plane[1] },
+        };
+        engine->simulation.setCamera(engine->camera);
+    });
+}
+
+void rc_step(rc_engine* engine, const rc_input* input, uint32_t ticks) {
+    guarded([&] () {
+        if(!engine->map || ticks == 0) {
+            return;
+        }
+
+        engine->simulation.setInput({
+            input->forward != 0,
+            input->backward != 0,
+            input->rotate_left != 0,
+            input->rotate_right != 0,
+            { 0.0, 0.0 },
+        });
+        engine->simulation.advance(ticks);
+        engine->camera = engine->simulation.latestCamera();
+    });
+}
+
+// the generation goes in the high bits plus one, so no handle is 0
+static inline rc_entity toEntity(EntityHandle handle) {
+    return (uint64_t(handle.generation) + 1) << 32 | handle.id;
+}
+
+static bool findEntity(rc_engine* engine, rc_entity entity, EntityHandle& handle) {
+    if(!engine->map) {
+        setError("there is no map loaded");
+        return false;
+    }
+
+    handle = { uint32_t(entity), uint32_t((entity >> 32) - 1) };
+    if(entity == 0 || !engine->map->entities.valid(handle)) {
+        setError("the entity does not exist");
+        return false;
+    }
+    return true;
+}
+
+rc_entity rc_entity_create(rc_engine* engine, float x, float y, uint32_t texture) {
+    return guarded<rc_entity>(0, [&] () -> rc_entity {
+        if(!engine->map) {
+            setError("there is no map loaded");
+            return 0;
+        }
+
+        return toEntity(engine->map->entities.create({ x, y, texture, 1, 1, 0.0f, 0 }, 0.0f));
+    });
+}
+
+void rc_entity_destroy(rc_engine* engine, rc_entity entity) {
+    guarded([&] () {
+        EntityHandle handle;
+        if(findEntity(engine, entity, handle)) {
+            engine->map->entities.destroy(handle);
+            engine->simulation.removeEntity(handle);
+        }
+    });
+}
+
+uint32_t rc_entity_count(const rc_engine* engine) {
+    return engine->map ? uint32_t(engine->map->entities.size()) : 0;
+}
+
+int rc_entity_set_position(rc_engine* engine, rc_entity entity, float x, float y) {
+    return guarded<int>(0, [&] () -> int {
+        EntityHandle handle;
+        if(!findEntity(engine, entity, handle)) {
+            return 0;
+        }
+
+        engine->map->entities.setPosition(handle, { x, y });
+        // only the entities that block the player are in the collisions of the simulation
+        const float radius = engine->map->entities.radius(engine->map->entities.indexOf(handle));
+        if(radius > 0.0f) {
+            engine->simulation.setEntity(handle, { x, y }, radius);
+        }
+        return 1;
+    });
+}
+
+int rc_entity_set_texture(rc_engine* engine, rc_entity entity, uint32_t texture) {
+    return guarded<int>(0, [&] () -> int {
+        EntityHandle handle;
+        if(!findEntity(engine, entity, handle)) {
+            return 0;
+        }
+
+        engine->map->entities.setTexture(handle, texture);
+        return 1;
+    });
+}
+
+int rc_entity_set_scale(rc_engine* engine, rc_entity entity, int32_t u_div, int32_t v_div, float v_move) {
+    return guarded<int>(0, [&] () -> int {
+        EntityHandle handle;
+        if(!findEntity(engine, entity, handle)) {
+            return 0;
+        }
+
+        if(u_div == 0 || v_div == 0) {
+            setError("the divisions of the size cannot be 0");
+            return 0;
+        }
+
+        engine->map->entities.setScale(handle, u_div, v_div, v_move);
+        return 1;
+    });
+}
+
+int rc_entity_set_flags(rc_engine* engine, rc_entity entity, uint32_t flags) {
+    return guarded<int>(0, [&] () -> int {
+        EntityHandle handle;
+        if(!findEntity(engine, entity, handle)) {
+            return 0;
+        }
+
+        engine->map->entities.setFlags(handle, flags);
+        return 1;
+    });
+}
+
+int rc_render(rc_engine* engine) {
+    return guarded<int>(0, [&] () -> int {
+        if(!engine->map) {
+            setError("there is no map loaded");
+            return 0;
+        }
+
+        engine->makeCurrent();
+        if(engine->mappedFrame) {
+            engine->frameBuffer->unmap();
+            engine->mappedFrame = nullptr;
+        }
+
+        engine->renderer->render(*engine->map, engine->camera);
+
+        // the copy into the buffer is done by the GPU, it is only waited when the frame is mapped
+        engine->frameSize = engine->renderer->getRenderSize();
+        const size_t frameBytes = size_t(engine->frameSize.x) * engine->frameSize.y * 4;
+        if(!engine->frameBuffer || engine->frameBuffer->size() != frameBytes) {
+            engine->frameBuffer.emplace(Buffer::PixelPackBuffer, frameBytes, Buffer::StreamRead);
+            engine->frameBuffer->setTag("frame readback");
+        }
+
+        engine->frameBuffer->bind();
+        engine->renderer->readPixels(nullptr);
+        Buffer::unbind(Buffer::PixelPackBuffer);
+        return 1;
+    });
+}
+
+const void* rc_get_framebuffer(rc_engine* engine, uint32_t* width, uint32_t* height) {
+    return guarded<const void*>(nullptr, [&] () -> const void* {
+        if(!engine->frameBuffer) {
+            return nullptr;
+        }
+
+        if(!engine->mappedFrame) {
+            engine->makeCurrent();
+            engine->mappedFrame = engine->frameBuffer->mapForRead();
+        }
+
+        if(width) *width = engine->frameSize.x;
+        if(height) *height = engine->frameSize.y;
+        return engine->mappedFrame;
+    });
+}
+
+int rc_read_framebuffer(rc_engine* engine, void* pixels, size_t size) {
+    return guarded<int>(0, [&] () -> int {
+        if(!engine->frameBuffer) {
+            setError("there is no frame rendered");
+            return 0;
+        }
+
+        const size_t frameBytes = engine->frameBuffer->size();
+        if(size < frameBytes) {
+            setError("the memory is smaller than the frame (" + std::to_string(frameBytes) + " bytes)");
+            return 0;
+        }
+
+        if(engine->mappedFrame) {
+            memcpy(pixels, engine->mappedFrame, frameBytes);
+            return 1;
+        }
+
+        engine->makeCurrent();
+        engine->frameBuffer->getSubData(0, pixels, frameBytes);
+        return 1;
+    });
+}
+
+rc_snapshot* rc_snapshot_take(rc_engine* engine) {
+    return guarded<rc_snapshot*>(nullptr, [&] () -> rc_snapshot* {
+        if(!engine->map) {
+            setError("there is no map loaded");
+            return nullptr;
+        }
+
+        auto snapshot = StateSnapshot::take(*engine->map, engine->camera, engine->lastSnapshot ? &*engine->lastSnapshot : nullptr);
+        engine->lastSnapshot = snapshot;
+        return new rc_snapshot { std::move(snapshot) };
+    });
+}
+
+int rc_snapshot_restore(rc_engine* engine, const rc_snapshot* snapshot) {
+    return guarded<int>(0, [&] () -> int {
+        if(!engine->map) {
+            setError("there is no map loaded");
+            return 0;
+        }
+
+        if(!snapshot->state.restore(*engine->map)) {
+            setError("the snapshot is of another map");
+            return 0;
+        }
+
+        engine->camera = snapshot->state.getCamera();
+        engine->simulation.restoreLevel(*engine->map, engine->camera);
+        return 1;
+    });
+}
+
+void rc_snapshot_free(rc_snapshot* snapshot) {
+    delete snapshot;
+}
+
+size_t rc_snapshot_serialize(const rc_snapshot* snapshot, void* data, size_t size) {
+    return guarded<size_t>(0, [&] () -> size_t {
+        const auto blob = snapshot->state.serialize();
+        if(data && size >= blob.size()) {
+            memcpy(data, blob.data(), blob.size());
+        }
+
+        return blob.size();
+    });
+}
+
+rc_snapshot* rc_snapshot_deserialize(const void* data, size_t size) {
+    return guarded<rc_snapshot*>(nullptr, [&] () -> rc_snapshot* {
+        auto state = StateSnapshot::deserialize((const uint8_t*) data, size);
+        if(state == std::nullopt) {
+            setError("the snapshot is invalid (the reason is in the standard error)");
+            return nullptr;
+        }
+
+        return new rc_snapshot { std::move(*state) };
+    });
+}
@@ -0,0 +1,160 @@
+#include <engine/batch-renderer.hpp>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <variant>
+#include <glad/glad.h>
+#include <engine/column-data.hpp>
+#include <engine/sprite.hpp>
+#include <opengl/check-error.hpp>
+
+BatchRenderer::BatchRenderer(uint32_t maxCameras, ivec2 size, Output output):
+    maxCameras(maxCameras),
+    size(size),
+    output(output),
+    raycasterProgram("batch-raycaster"),
+    spritecasterProgram("batch-spritecaster"),
+    floorcasterProgram("batch-floorcaster"),
+    drawerProgram("batch-drawer"),
+    camerasBuffer(Buffer::ShaderStorageBuffer, maxCameras * sizeof(BatchCamera), Buffer::DynamicDraw),
+    columnsBuffer(Buffer::ShaderStorageBuffer, size_t(maxCameras) * size.x * sizeof(ColumnData)),
+    spritesBuffer(Buffer::ShaderStorageBuffer, maxSprites * sizeof(Sprite), Buffer::DynamicDraw),
+    spriteResultsBuffer(Buffer::ShaderStorageBuffer, maxCameras * maxSprites * sizeof(SpriteData)),
+    tensorBuffer(Buffer::ShaderStorageBuffer, maxCameras * imageBytes(), Buffer::DynamicRead),
+    layersTexture(Texture::Array2D) {
+    camerasBuffer.setTag("batch cameras");
+    columnsBuffer.setTag("batch raycaster");
+    spritesBuffer.setTag("batch sprites");
+    spriteResultsBuffer.setTag("batch spritecaster");
+    tensorBuffer.setTag("batch output");
+    layersTexture.setTag("batch output");
+}
+
+bool BatchRenderer::load(Map& map, const Shader::Defines& textureDefines, uint32_t rayRefineStep) {
+    Shader::Defines defines = textureDefines;
+    defines["BATCH"] = "1";
+    if(output == Tensor) {
+        defines["BATCH_TENSOR"] = "1";
+    }
+
+    Shader::Defines raycasterDefines = defines;
+    raycasterDefines["RAY_REFINE_STEP"] = std::to_string(rayRefineStep);
+    Shader::Defines floorcasterDefines = defines;
+    const auto mapDefines = map.shaderDefines();
+    floorcasterDefines.insert(mapDefines.begin(), mapDefines.end());
+
+    Shader raycasterShader(Shader::Compute);
+    Shader spritecasterShader(Shader::Compute);
+    Shader floorcasterShader(Shader::Compute);
+    Shader drawerShader(Shader::Compute);
+    if(
+        !raycasterShader.loadAndCompile("raycaster.glsl", raycasterDefines) ||
+        !spritecasterShader.loadAndCompile("spritecaster.glsl", defines) ||
+        !floorcasterShader.loadAndCompile("floorcaster.glsl", floorcasterDefines) ||
+        !drawerShader.loadAndCompile("batch-drawer.glsl", defines)
+    ) {
+        return false;
+    }
+
+    if(
+        !raycasterProgram.link({ &raycasterShader }) ||
+        !spritecasterProgram.link({ &spritecasterShader }) ||
+        !floorcasterProgram.link({ &floorcasterShader }) ||
+        !drawerProgram.link({ &drawerShader })
+    ) {
+        return false;
+    }
+
+#ifndef NDEBUG
+    if(
+        !raycasterProgram.checkBufferLayout("cameras[0].plane", offsetof(BatchCamera, plane), sizeof(BatchCamera)) ||
+        !drawerProgram.checkBufferLayout("spriteResults[0].texture", offsetof(SpriteData, texture), sizeof(SpriteData))
+    ) {
+        return false;
+    }
+#endif
+
+    map.entities.markAllChanged();
+
+    raycasterProgram.use();
+    raycasterProgram.setUniform("screenSize", size.x, size.y);
+    spritecasterProgram.use();
+    spritecasterProgram.setUniform("screenSize", size.x, size.y);
+    floorcasterProgram.use();
+    floorcasterProgram.setUniform("screenSize", size.x, size.y);
+    // the type of these uniforms depends on the variant of the floorcaster (see Map::shaderDefines)
+    std::visit([this] (auto floor) { floorcasterProgram.setUniform("floorTex", floor); }, map.floor);
+    std::visit([this] (auto ceil) { floorcasterProgram.setUniform("ceilTex", ceil); }, map.ceil);
+    drawerProgram.use();
+    drawerProgram.setUniform("screenSize", size.x, size.y);
+
+    if(output == Layers) {
+        layersTexture.bind();
+        layersTexture.setMinFilter(Texture::Nearest);
+        layersTexture.setMagFilter(Texture::Nearest);
+        layersTexture.reserveStorage3D(Texture::RGBA8, { size.x, size.y, int(maxCameras) });
+    }
+
+    return true;
+}
+
+void BatchRenderer::render(Map& map, Texture& textures, const BatchCamera* cameras, uint32_t count) {
+    camerasBuffer.setSubData(0, cameras, count * sizeof(BatchCamera));
+    map.uploadChanges();
+    // every sprite is placed for every camera, so only the first ones are used
+    map.entities.uploadChanges(spritesBuffer, maxSprites);
+    const uint32_t entities = uint32_t(std::min(map.entities.size(), maxSprites));
+    if(spriteCount != entities) {
+        spriteCount = entities;
+        spritecasterProgram.use();
+        spritecasterProgram.setUniform("spriteCount", spriteCount);
+        drawerProgram.use();
+        drawerProgram.setUniform("spriteCount", spriteCount);
+    }
+
+    // the columns of all the cameras, one after the other
+    map.texture->bindImage(1);
+    camerasBuffer.bindBase(6);
+    columnsBuffer.bindBase(2);
+    raycasterProgram.use();
+    raycasterProgram.dispatchCompute((size.x + 63) / 64, count);
+
+    // every sprite for every camera, there is no culling (the drawer skips the ones behind the camera)
+    if(spriteCount > 0) {
+        spritesBuffer.bindBase(1);
+        spriteResultsBuffer.bindBase(2);
+        spritecasterProgram.use();
+        spritecasterProgram.dispatchCompute((spriteCount + 63) / 64, count);
+    }
+
+    // the floor and ceiling go straight into the output, the drawer writes the rest over them
+    if(output == Tensor) {
+        tensorBuffer.bindBase(7);
+    } else {
+        layersTexture.bindImage(3, 0, true, 0);
+    }
+    textures.bindImage(1, 0, false, 0);
+    floorcasterProgram.use();
+    floorcasterProgram.dispatchCompute((size.x + 32 * 8 - 1) / (32 * 8), (size.y / 2 + 7) / 8, count);
+    checkGlError(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT));
+
+    columnsBuffer.bindBase(2);
+    spriteResultsBuffer.bindBase(3);
+    drawerProgram.use();
+    drawerProgram.dispatchCompute((size.x + 7) / 8, (size.y + 7) / 8, count);
+}
+
+void BatchRenderer::readImages(std::vector<uint8_t>& pixels, uint32_t count) {
+    if(output == Tensor) {
+        checkGlError(glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT));
+        pixels.resize(count * imageBytes());
+        tensorBuffer.getSubData(0, pixels.data(), pixels.size());
+    } else {
+        // GL 4.3 can only read all the layers
+        checkGlError(glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT));
+        pixels.resize(maxCameras * imageBytes());
+        layersTexture.bind();
+        layersTexture.getImage(0, Texture::RGBA, Texture::UnsignedByte, pixels.data());
+        pixels.resize(count * imageBytes());
+    }
+}
@@ -0,0 +1,76 @@
+#include <engine/collision.hpp>
+#include <algorithm>
+#include <cmath>
+
+static inline bool isWall(const MapGrid& grid, int32_t x, int32_t y) {
+    const glm::uvec2 size = grid.size();
+    return x < 0 || y < 0 || uint32_t(x) >= size.x || uint32_t(y) >= size.y || grid.at(x, y) != 0;
+}
+
+static glm::vec2 pushOutOfWalls(const MapGrid& grid, glm::vec2 pos, float radius) {
+    const int32_t fromX = int32_t(std::floor(pos.x - radius)), toX = int32_t(std::floor(pos.x + radius));
+    const int32_t fromY = int32_t(std::floor(pos.y - radius)), toY = int32_t(std::floor(pos.y + radius));
+    for(int32_t x = fromX; x <= toX; x += 1) {
+        for(int32_t y = fromY; y <= toY; y += 1) {
+            if(!isWall(grid, x, y)) {
+                continue;
+            }
+
+            // the point of the cell nearest to the center, the circle is pushed away from it
+            const glm::vec2 nearest(std::clamp(pos.x, float(x), float(x + 1)), std::clamp(pos.y, float(y), float(y + 1)));
+            const glm::vec2 distance = pos - nearest;
+            const float squared = distance.x * distance.x + distance.y * distance.y;
+            if(squared >= radius * radius) {
+                continue;
+            }
+
+            if(squared > 0.0f) {
+                pos = nearest + distance * (radius / std::sqrt(squared));
+                continue;
+            }
+
+            // the center is inside the wall, it goes out through the nearest side
+            const float left = pos.x - x, right = x + 1 - pos.x, top = pos.y - y, bottom = y + 1 - pos.y;
+            const float side = std::min({ left, right, top, bottom });
+            if(side == left) {
+                pos.x = x - radius;
+            } else if(side == right) {
+                pos.x = x + 1 + radius;
+            } else if(side == top) {
+                pos.y = y - radius;
+            } else {
+                pos.y = y + 1 + radius;
+            }
+        }
+    }
+    return pos;
+}
+
+glm::vec2 moveCircle(const MapGrid& grid, glm::vec2 pos, glm::vec2 movement, float radius) {
+    // steps of half the radius at most
+    const float length = std::sqrt(movement.x * movement.x + movement.y * movement.y);
+    const int32_t steps = std::max(1, int32_t(std::ceil(length / (radius * 0.5f))));
+    const glm::vec2 step = movement / float(steps);
+    for(int32_t i = 0; i < steps; i += 1) {
+        pos = pushOutOfWalls(grid, pos + step, radius);
+    }
+    return pos;
+}
+
+glm::vec2 separateCircle(const SpatialHash& entities, glm::vec2 pos, float radius, std::vector<uint32_t>& nearby, uint32_t ignore) {
+    entities.queryRadius(pos, radius, nearby);
+    for(uint32_t id : nearby) {
+        const float reach = radius + entities.radius(id);
+        const glm::vec2 distance = pos - entities.position(id);
+        const float squared = distance.x * distance.x + distance.y * distance.y;
+        if(id == ignore || squared >= reach * reach) {
+            continue;
+        }
+
+        // in the same point there is no direction, any one works
+        pos = squared > 0.0f
+            ? entities.position(id) + distance * (reach / std::sqrt(squared))
+            : entities.position(id) + glm::vec2(reach, 0.0f);
+    }
+    return pos;
+}
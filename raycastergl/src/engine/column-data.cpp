@@ -0,0 +1,35 @@
+#include <engine/column-data.hpp>
+#include <cctype>
+#include <sstream>
+
+std::string columnDataGlsl() {
+    std::stringstream glsl;
+    glsl << "struct xdata {" << std::endl
+         << "    uint bits;" << std::endl
+         << "    float distWall;" << std::endl
+         << "};" << std::endl;
+
+#define COLUMN_DATA_GETTER(name, offset, count) \
+    { \
+        std::string fn = #name; \
+        fn[0] = toupper(fn[0]); \
+        glsl << "uint xdata" << fn << "(xdata data) { return bitfieldExtract(data.bits, " \
+             << offset << ", " << count << "); }" << std::endl; \
+    }
+    COLUMN_DATA_FIELDS(COLUMN_DATA_GETTER)
+#undef COLUMN_DATA_GETTER
+
+#define COLUMN_DATA_ARGUMENT(name, offset, count) "uint " #name ", "
+    glsl << "xdata packXdata(" COLUMN_DATA_FIELDS(COLUMN_DATA_ARGUMENT) "float distWall) {" << std::endl
+         << "    uint bits = 0u;" << std::endl;
+#undef COLUMN_DATA_ARGUMENT
+
+#define COLUMN_DATA_SETTER(name, offset, count) \
+    glsl << "    bits = bitfieldInsert(bits, " #name ", " << offset << ", " << count << ");" << std::endl;
+    COLUMN_DATA_FIELDS(COLUMN_DATA_SETTER)
+#undef COLUMN_DATA_SETTER
+
+    glsl << "    return xdata(bits, distWall);" << std::endl
+         << "}" << std::endl;
+    return glsl.str();
+}
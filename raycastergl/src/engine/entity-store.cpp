@@ -0,0 +1,225 @@
+#include <engine/entity-store.hpp>
+#include <algorithm>
+#include <cstring>
+
+template<typename T>
+static bool sameRange(const std::vector<T>& a, const std::vector<T>& b, size_t start, size_t end) {
+    return memcmp(a.data() + start, b.data() + start, (end - start) * sizeof(T)) == 0;
+}
+
+void EntityStore::markChanged(uint32_t index) {
+    const uint32_t block = index / blockSize;
+    if(changedBlocks.size() <= block) {
+        changedBlocks.resize(block + 1, 0);
+    }
+
+    changedBlocks[block] = 1;
+    changed = true;
+    changes += 1;
+}
+
+void EntityStore::markAllChanged() {
+    changedBlocks.assign((size() + blockSize - 1) / blockSize, 1);
+    changed = true;
+    changes += 1;
+}
+
+EntityHandle EntityStore::create(const Sprite& sprite, float radius) {
+    uint32_t id;
+    if(!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        id = uint32_t(slots.size());
+        slots.push_back({ UINT32_MAX, 0 });
+    }
+
+    const uint32_t index = uint32_t(positions.size());
+    slots[id].index = index;
+    positions.emplace_back(sprite.x, sprite.y);
+    textures.push_back(sprite.texture);
+    divisions.emplace_back(sprite.uDiv, sprite.vDiv);
+    vMoves.push_back(sprite.vMove);
+    flags.push_back(sprite.flags);
+    radii.push_back(radius);
+    ids.push_back(id);
+    markChanged(index);
+    return { id, slots[id].generation };
+}
+
+void EntityStore::destroy(EntityHandle handle) {
+    if(!valid(handle)) {
+        return;
+    }
+
+    // the last entity fills the hole, so the buffer stays packed
+    const uint32_t index = slots[handle.id].index;
+    const uint32_t last = uint32_t(size() - 1);
+    if(index != last) {
+        positions[index] = positions[last];
+        textures[index] = textures[last];
+        divisions[index] = divisions[last];
+        vMoves[index] = vMoves[last];
+        flags[index] = flags[last];
+        radii[index] = radii[last];
+        ids[index] = ids[last];
+        slots[ids[index]].index = index;
+        markChanged(index);
+    }
+
+    positions.pop_back();
+    textures.pop_back();
+    divisions.pop_back();
+    vMoves.pop_back();
+    flags.pop_back();
+    radii.pop_back();
+    ids.pop_back();
+    slots[handle.id].index = UINT32_MAX;
+    slots[handle.id].generation += 1;
+    freeIds.push_back(handle.id);
+    changes += 1;
+}
+
+void EntityStore::clear() {
+    for(uint32_t id : ids) {
+        slots[id].index = UINT32_MAX;
+        slots[id].generation += 1;
+        freeIds.push_back(id);
+    }
+
+    positions.clear();
+    textures.clear();
+    divisions.clear();
+    vMoves.clear();
+    flags.clear();
+    radii.clear();
+    ids.clear();
+    changedBlocks.clear();
+    changed = false;
+    changes += 1;
+}
+
+void EntityStore::setPosition(EntityHandle handle, glm::vec2 pos) {
+    const uint32_t index = slots[handle.id].index;
+    positions[index] = pos;
+    markChanged(index);
+}
+
+void EntityStore::setTexture(EntityHandle handle, uint32_t texture) {
+    const uint32_t index = slots[handle.id].index;
+    textures[index] = texture;
+    markChanged(index);
+}
+
+void EntityStore::setScale(EntityHandle handle, int32_t uDiv, int32_t vDiv, float vMove) {
+    const uint32_t index = slots[handle.id].index;
+    divisions[index] = glm::ivec2(uDiv, vDiv);
+    vMoves[index] = vMove;
+    markChanged(index);
+}
+
+void EntityStore::setFlags(EntityHandle handle, uint32_t value) {
+    const uint32_t index = slots[handle.id].index;
+    flags[index] = value;
+    markChanged(index);
+}
+
+void EntityStore::setRadius(EntityHandle handle, float radius) {
+    radii[slots[handle.id].index] = radius;
+}
+
+Sprite EntityStore::sprite(uint32_t index) const {
+    return {
+        positions[index].x,
+        positions[index].y,
+        textures[index],
+        divisions[index].x,
+        divisions[index].y,
+        vMoves[index],
+        flags[index],
+    };
+}
+
+void EntityStore::assign(const EntityStore& other) {
+    // the version keeps growing, the one of the other store could be already seen
+    const uint64_t version = changes + 1;
+    if(size() != other.size()) {
+        *this = other;
+        markAllChanged();
+        changes = version;
+        return;
+    }
+
+    // the changes of this store that are not uploaded yet are kept
+    std::vector<uint8_t> pendingBlocks = std::move(changedBlocks);
+    pendingBlocks.resize((size() + blockSize - 1) / blockSize, 0);
+    for(size_t block = 0; block < pendingBlocks.size(); block += 1) {
+        const size_t start = block * blockSize;
+        const size_t end = std::min(start + blockSize, size());
+        const bool same = sameRange(positions, other.positions, start, end)
+            && sameRange(textures, other.textures, start, end)
+            && sameRange(divisions, other.divisions, start, end)
+            && sameRange(vMoves, other.vMoves, start, end)
+            && sameRange(flags, other.flags, start, end);
+        if(!same) {
+            pendingBlocks[block] = 1;
+        }
+    }
+
+    const bool pending = changed || std::find(pendingBlocks.begin(), pendingBlocks.end(), 1) != pendingBlocks.end();
+    *this = other;
+    changedBlocks = std::move(pendingBlocks);
+    changed = pending;
+    changes = version;
+}
+
+void EntityStore::pack(uint32_t start, uint32_t end) {
+    staging.resize(end - start);
+    for(uint32_t i = start; i < end; i += 1) {
+        staging[i - start] = sprite(i);
+    }
+}
+
+size_t EntityStore::uploadChanges(Buffer& buffer, uint32_t maxCount) {
+    const uint32_t count = uint32_t(std::min<size_t>(size(), maxCount));
+    const size_t bytes = size_t(count) * sizeof(Sprite);
+    if(buffer.size() < bytes) {
+        // twice the size, so adding entities one by one does not grow the buffer every frame
+        pack(0, count);
+        staging.resize(std::max<size_t>(count, buffer.size() / sizeof(Sprite) * 2));
+        buffer.setData(staging.data(), staging.size());
+        std::fill(changedBlocks.begin(), changedBlocks.end(), 0);
+        changed = false;
+        return bytes;
+    }
+
+    if(!changed) {
+        return 0;
+    }
+
+    // the consecutive changed blocks are joined, one upload for each range
+    size_t uploaded = 0;
+    const uint32_t blocks = std::min(uint32_t(changedBlocks.size()), (count + blockSize - 1) / blockSize);
+    for(uint32_t block = 0; block < blocks;) {
+        if(!changedBlocks[block]) {
+            block += 1;
+            continue;
+        }
+
+        uint32_t end = block;
+        while(end < blocks && changedBlocks[end]) {
+            end += 1;
+        }
+
+        const uint32_t first = block * blockSize;
+        const uint32_t last = std::min(end * blockSize, count);
+        pack(first, last);
+        buffer.setSubData(size_t(first) * sizeof(Sprite), staging.data(), staging.size() * sizeof(Sprite));
+        uploaded += staging.size() * sizeof(Sprite);
+        block = end;
+    }
+
+    std::fill(changedBlocks.begin(), changedBlocks.end(), 0);
+    changed = false;
+    return uploaded;
+}
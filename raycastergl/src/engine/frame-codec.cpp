@@ -0,0 +1,150 @@
+#include <engine/frame-codec.hpp>
+#include <algorithm>
+#include <cstring>
+#include <lz4.h>
+
+static constexpr char frameMagic[4] = { 'R', 'C', 'F', 'S' };
+static constexpr size_t tileEntryBytes = 2 * sizeof(uint32_t);
+
+// section of the image covered by a tile (the tiles of the last row and column can be smaller)
+struct TileRect {
+    uvec2 start;
+    uvec2 size;
+};
+
+static inline TileRect tileRect(uvec2 imageSize, uint32_t tileSize, uint32_t tile) {
+    const uint32_t tilesX = (imageSize.x + tileSize - 1) / tileSize;
+    const uvec2 start((tile % tilesX) * tileSize, (tile / tilesX) * tileSize);
+    return { start, uvec2(std::min(tileSize, imageSize.x - start.x), std::min(tileSize, imageSize.y - start.y)) };
+}
+
+static inline uint32_t tileCount(uvec2 imageSize, uint32_t tileSize) {
+    return ((imageSize.x + tileSize - 1) / tileSize) * ((imageSize.y + tileSize - 1) / tileSize);
+}
+
+template<typename T>
+static inline void writeAt(std::vector<uint8_t>& output, size_t offset, const T& value) {
+    memcpy(output.data() + offset, &value, sizeof(T));
+}
+
+size_t FrameEncoder::encode(const uint8_t* pixels, uvec2 size, uint64_t number, bool keyframe, std::vector<uint8_t>& output) {
+    const size_t rowBytes = size_t(size.x) * 4;
+    if(this->size != size) {
+        this->size = size;
+        previous.resize(rowBytes * size.y);
+        keyframe = true;
+    }
+
+    // the output has room for every tile (even if none compresses)
+    const uint32_t tiles = tileCount(size, tileSize);
+    const int maxTileBytes = tileSize * tileSize * 4;
+    const size_t maxBytes = sizeof(StreamFrameHeader) + tiles * (tileEntryBytes + LZ4_compressBound(maxTileBytes));
+    if(output.size() < maxBytes) {
+        output.resize(maxBytes);
+    }
+    tile.resize(maxTileBytes);
+
+    size_t offset = sizeof(StreamFrameHeader);
+    changedTiles = 0;
+    for(uint32_t i = 0; i < tiles; i += 1) {
+        const TileRect rect = tileRect(size, tileSize, i);
+        const size_t tileRowBytes = size_t(rect.size.x) * 4;
+        const size_t firstByte = rect.start.y * rowBytes + rect.start.x * 4;
+
+        bool changed = keyframe;
+        for(uint32_t y = 0; y < rect.size.y && !changed; y += 1) {
+            const size_t row = firstByte + y * rowBytes;
+            changed = memcmp(pixels + row, previous.data() + row, tileRowBytes) != 0;
+        }
+
+        if(!changed) {
+            continue;
+        }
+
+        // the rows of the tile are packed together, and kept for the next frame
+        for(uint32_t y = 0; y < rect.size.y; y += 1) {
+            const size_t row = firstByte + y * rowBytes;
+            memcpy(tile.data() + y * tileRowBytes, pixels + row, tileRowBytes);
+            memcpy(previous.data() + row, pixels + row, tileRowBytes);
+        }
+
+        const int rawBytes = int(tileRowBytes * rect.size.y);
+        uint8_t* data = output.data() + offset + tileEntryBytes;
+        int compressedBytes = LZ4_compress_default((const char*) tile.data(), (char*) data, rawBytes, LZ4_compressBound(rawBytes));
+        // a tile with the raw size is not compressed
+        if(compressedBytes <= 0 || compressedBytes >= rawBytes) {
+            memcpy(data, tile.data(), rawBytes);
+            compressedBytes = rawBytes;
+        }
+
+        writeAt(output, offset, i);
+        writeAt(output, offset + sizeof(uint32_t), uint32_t(compressedBytes));
+        offset += tileEntryBytes + compressedBytes;
+        changedTiles += 1;
+    }
+
+    StreamFrameHeader header = {};
+    memcpy(header.magic, frameMagic, sizeof(frameMagic));
+    header.width = size.x;
+    header.height = size.y;
+    header.tileSize = tileSize;
+    header.number = number;
+    header.keyframe = keyframe;
+    header.changedTiles = changedTiles;
+    header.payloadBytes = uint32_t(offset - sizeof(StreamFrameHeader));
+    writeAt(output, 0, header);
+    return offset;
+}
+
+bool FrameDecoder::decode(const StreamFrameHeader& header, const uint8_t* payload) {
+    if(memcmp(header.magic, frameMagic, sizeof(frameMagic)) != 0 || header.tileSize == 0 || header.tileSize > 256) {
+        return false;
+    }
+
+    const uvec2 frameSize(header.width, header.height);
+    if(!header.keyframe && frameSize != size) {
+        return false;
+    }
+
+    const size_t rowBytes = size_t(frameSize.x) * 4;
+    if(frameSize != size) {
+        size = frameSize;
+        pixels.assign(rowBytes * size.y, 0);
+    }
+
+    const uint32_t tiles = tileCount(size, header.tileSize);
+    tile.resize(size_t(header.tileSize) * header.tileSize * 4);
+    size_t offset = 0;
+    for(uint32_t i = 0; i < header.changedTiles; i += 1) {
+        uint32_t index, dataBytes;
+        if(header.payloadBytes - offset < tileEntryBytes) {
+            return false;
+        }
+
+        memcpy(&index, payload + offset, sizeof(uint32_t));
+        memcpy(&dataBytes, payload + offset + sizeof(uint32_t), sizeof(uint32_t));
+        offset += tileEntryBytes;
+        if(index >= tiles || header.payloadBytes - offset < dataBytes) {
+            return false;
+        }
+
+        const TileRect rect = tileRect(size, header.tileSize, index);
+        const size_t tileRowBytes = size_t(rect.size.x) * 4;
+        const int rawBytes = int(tileRowBytes * rect.size.y);
+        const uint8_t* data = payload + offset;
+        if(int(dataBytes) != rawBytes) {
+            if(LZ4_decompress_safe((const char*) data, (char*) tile.data(), int(dataBytes), rawBytes) != rawBytes) {
+                return false;
+            }
+            data = tile.data();
+        }
+
+        const size_t firstByte = rect.start.y * rowBytes + rect.start.x * 4;
+        for(uint32_t y = 0; y < rect.size.y; y += 1) {
+            memcpy(pixels.data() + firstByte + y * rowBytes, data + y * tileRowBytes, tileRowBytes);
+        }
+        offset += dataBytes;
+    }
+
+    return offset == header.payloadBytes;
+}
@@ -0,0 +1,52 @@
+#include <engine/frame-pacer.hpp>
+#include <algorithm>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// the sleep wakes up this time before the frame, and the rest is waited spinning
+static constexpr auto spinTime = 2ms;
+
+FramePacer::FramePacer(double maxFps):
+    frameDuration(maxFps > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / maxFps)) : Clock::duration::zero()),
+    nextFrame(Clock::now()) {}
+
+void FramePacer::waitForNextFrame() {
+    if(frameDuration == Clock::duration::zero()) {
+        return;
+    }
+
+    if(auto now = Clock::now(); nextFrame - now > spinTime) {
+        std::this_thread::sleep_for(nextFrame - now - spinTime);
+    }
+
+    while(Clock::now() < nextFrame) {
+        std::this_thread::yield();
+    }
+
+    // if the frame was late by more than a frame, the lost time is not recovered with shorter frames
+    auto now = Clock::now();
+    nextFrame += frameDuration;
+    if(nextFrame < now) {
+        nextFrame = now + frameDuration;
+    }
+}
+
+void FramePacer::inputSampled() {
+    inputTime = Clock::now();
+}
+
+void FramePacer::frameSwapped() {
+    double latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - inputTime).count();
+    latencySumMs += latencyMs;
+    latencyMaxMs = std::max(latencyMaxMs, latencyMs);
+    latencySamples += 1;
+}
+
+FramePacer::LatencyStats FramePacer::takeLatencyStats() {
+    LatencyStats stats = { latencySamples ? latencySumMs / latencySamples : 0.0, latencyMaxMs };
+    latencySumMs = 0.0;
+    latencyMaxMs = 0.0;
+    latencySamples = 0;
+    return stats;
+}
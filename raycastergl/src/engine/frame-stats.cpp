@@ -0,0 +1,255 @@
+#include <engine/frame-stats.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <opengl/gpu-memory.hpp>
+
+static const char* const sectionNames[FrameStats::SectionCount] = { "frame", "cpu", "swap", "ticks" };
+
+static double toMs(FrameStats::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+static double toSeconds(FrameStats::Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+static double toMiB(size_t bytes) {
+    return double(bytes) / (1024.0 * 1024.0);
+}
+
+static void printInterval(const char* title, const FrameStats::Interval& interval) {
+    // clears the fps line before
+    printf("\r%64s\r> %s (%.1fs - %.1fs)\n", "", title, interval.start, interval.end);
+    for(size_t i = 0; i < FrameStats::SectionCount; i++) {
+        const auto& section = interval.sections[i];
+        printf(
+            "    %-5s %7llu  p50 %7.2fms  p90 %7.2fms  p99 %7.2fms  max %7.2fms",
+            sectionNames[i],
+            (unsigned long long) section.count,
+            section.p50Ms,
+            section.p90Ms,
+            section.p99Ms,
+            section.maxMs
+        );
+        if(section.maxTime >= 0.0) {
+            printf(" at %.2fs", section.maxTime);
+        }
+        printf("\n");
+    }
+    printf(
+        "    gpu memory  buffers %.2f MiB  textures %.2f MiB  renderbuffers %.2f MiB\n",
+        toMiB(GpuMemory::totalBytes(GpuMemory::Buffers)),
+        toMiB(GpuMemory::totalBytes(GpuMemory::Textures)),
+        toMiB(GpuMemory::totalBytes(GpuMemory::Renderbuffers))
+    );
+    fflush(stdout);
+}
+
+FrameStats::FrameStats(double intervalSeconds, const std::string& statsFile):
+    interval(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(intervalSeconds))),
+    statsFile(statsFile),
+    start(Clock::now()),
+    intervalStart(start),
+    lastSwapEnd(start) {
+    worstFrames.reserve(worstFramesCount + 1);
+}
+
+void FrameStats::record(Section section, double ms, double time) {
+    if(ms > intervalHistograms[section].max()) {
+        intervalMaxTime[section] = time;
+    }
+
+    intervalHistograms[section].record(ms);
+}
+
+void FrameStats::frameFinished(Clock::time_point cpuStart, Clock::time_point swapStart, Clock::time_point swapEnd, Simulation& simulation) {
+    const double time = toSeconds(swapEnd - start);
+    // the first frame has nothing before to compare with
+    if(frameNumber > 0) {
+        const double frameMs = toMs(swapEnd - lastSwapEnd);
+        record(Frame, frameMs, time);
+        lastFrame = frameMs;
+
+        if(worstFrames.size() < worstFramesCount || frameMs > worstFrames.back().ms) {
+            auto position = std::find_if(worstFrames.begin(), worstFrames.end(), [frameMs] (auto& f) { return f.ms < frameMs; });
+            worstFrames.insert(position, { frameMs, time, frameNumber });
+            if(worstFrames.size() > worstFramesCount) {
+                worstFrames.pop_back();
+            }
+        }
+    }
+
+    record(Cpu, toMs(swapStart - cpuStart), time);
+    record(Swap, toMs(swapEnd - swapStart), time);
+    lastSwapEnd = swapEnd;
+    frameNumber += 1;
+
+    if(interval > Clock::duration::zero() && swapEnd - intervalStart >= interval) {
+        finishInterval(simulation, swapEnd);
+    }
+}
+
+FrameStats::Interval FrameStats::summarize(
+    double from,
+    double to,
+    const std::array<TimeHistogram, SectionCount>& histograms,
+    const std::array<double, SectionCount>& maxTimes
+) const {
+    Interval result = { from, to, {} };
+    for(size_t i = 0; i < SectionCount; i++) {
+        const TimeHistogram& histogram = histograms[i];
+        result.sections[i] = {
+            histogram.count(),
+            histogram.mean(),
+            histogram.percentile(50.0),
+            histogram.percentile(90.0),
+            histogram.percentile(99.0),
+            histogram.max(),
+            i == Ticks || histogram.count() == 0 ? -1.0 : maxTimes[i],
+        };
+    }
+
+    return result;
+}
+
+void FrameStats::finishInterval(Simulation& simulation, Clock::time_point now) {
+    simulation.takeTickTimes(intervalHistograms[Ticks]);
+
+    if(interval > Clock::duration::zero() || !statsFile.empty()) {
+        Interval summary = summarize(toSeconds(intervalStart - start), toSeconds(now - start), intervalHistograms, intervalMaxTime);
+        if(interval > Clock::duration::zero()) {
+            printInterval("Frame stats", summary);
+        }
+        if(!statsFile.empty()) {
+            intervals.push_back(summary);
+        }
+    }
+
+    for(size_t i = 0; i < SectionCount; i++) {
+        if(intervalHistograms[i].max() > totalHistograms[i].max()) {
+            totalMaxTime[i] = intervalMaxTime[i];
+        }
+
+        totalHistograms[i].merge(intervalHistograms[i]);
+        intervalHistograms[i].reset();
+    }
+
+    intervalStart = now;
+}
+
+void FrameStats::finish(Simulation& simulation) {
+    const auto now = Clock::now();
+    finishInterval(simulation, now);
+
+    Interval total = summarize(0.0, toSeconds(now - start), totalHistograms, totalMaxTime);
+    printInterval("Frame stats of the whole run", total);
+    printf("    worst frames:");
+    for(size_t i = 0; i < worstFrames.size(); i++) {
+        printf("%s %.2fms at %.2fs", i ? "," : "", worstFrames[i].ms, worstFrames[i].time);
+    }
+    printf("\n");
+
+    if(statsFile.empty()) {
+        return;
+    }
+
+    const bool json = statsFile.size() >= 5 && statsFile.compare(statsFile.size() - 5, 5, ".json") == 0;
+    if(json ? writeJson(total) : writeCsv(total)) {
+        std::cout << "> Frame stats written to " << statsFile << std::endl;
+    } else {
+        std::cerr << "  Could not write the frame stats to " << statsFile << std::endl;
+    }
+}
+
+bool FrameStats::writeCsv(const Interval& total) const {
+    std::ofstream file(statsFile);
+    if(!file) {
+        return false;
+    }
+
+    file << "interval,start_s,end_s,section,count,mean_ms,p50_ms,p90_ms,p99_ms,max_ms,max_at_s\n";
+    auto writeRows = [&file] (const std::string& name, const Interval& interval) {
+        for(size_t i = 0; i < SectionCount; i++) {
+            const auto& section = interval.sections[i];
+            file << name << ',' << interval.start << ',' << interval.end << ',' << sectionNames[i] << ','
+                << section.count << ',' << section.meanMs << ',' << section.p50Ms << ',' << section.p90Ms << ','
+                << section.p99Ms << ',' << section.maxMs << ',';
+            if(section.maxTime >= 0.0) {
+                file << section.maxTime;
+            }
+            file << '\n';
+        }
+    };
+
+    for(size_t i = 0; i < intervals.size(); i++) {
+        writeRows(std::to_string(i), intervals[i]);
+    }
+    writeRows("total", total);
+    return bool(file);
+}
+
+bool FrameStats::writeJson(const Interval& total) const {
+    std::ofstream file(statsFile);
+    if(!file) {
+        return false;
+    }
+
+    auto writeSections = [&file] (const Interval& interval) {
+        file << "{\"start\":" << interval.start << ",\"end\":" << interval.end << ",\"sections\":{";
+        for(size_t i = 0; i < SectionCount; i++) {
+            const auto& section = interval.sections[i];
+            file << (i ? "," : "") << '"' << sectionNames[i] << "\":{\"count\":" << section.count
+                << ",\"meanMs\":" << section.meanMs << ",\"p50Ms\":" << section.p50Ms << ",\"p90Ms\":" << section.p90Ms
+                << ",\"p99Ms\":" << section.p99Ms << ",\"maxMs\":" << section.maxMs;
+            if(section.maxTime >= 0.0) {
+                file << ",\"maxAt\":" << section.maxTime;
+            }
+            file << '}';
+        }
+        file << "}}";
+    };
+
+    file << "{\"intervals\":[";
+    for(size_t i = 0; i < intervals.size(); i++) {
+        file << (i ? ",\n" : "\n");
+        writeSections(intervals[i]);
+    }
+
+    file << "\n],\"total\":";
+    writeSections(total);
+
+    // the full histograms of the run, as pairs of [milliseconds, count] (empty buckets are skipped)
+    file << ",\n\"histograms\":{";
+    for(size_t i = 0; i < SectionCount; i++) {
+        file << (i ? "," : "") << "\n\"" << sectionNames[i] << "\":[";
+        bool first = true;
+        for(size_t bucket = 0; bucket < TimeHistogram::bucketCount; bucket++) {
+            if(uint32_t count = totalHistograms[i].valuesIn(bucket); count > 0) {
+                file << (first ? "" : ",") << '[' << TimeHistogram::bucketMs(bucket) << ',' << count << ']';
+                first = false;
+            }
+        }
+        file << ']';
+    }
+
+    file << "\n},\n\"worstFrames\":[";
+    for(size_t i = 0; i < worstFrames.size(); i++) {
+        const auto& frame = worstFrames[i];
+        file << (i ? "," : "") << "{\"ms\":" << frame.ms << ",\"at\":" << frame.time << ",\"frame\":" << frame.frame << '}';
+    }
+
+    // the GPU memory of each owner at the end of the run
+    file << "],\n\"gpuMemory\":[";
+    const auto usages = GpuMemory::usageByTag();
+    for(size_t i = 0; i < usages.size(); i++) {
+        const auto& usage = usages[i];
+        file << (i ? "," : "") << "\n{\"tag\":\"" << usage.tag << "\",\"objects\":" << usage.objects
+            << ",\"bufferBytes\":" << usage.bytes[GpuMemory::Buffers]
+            << ",\"textureBytes\":" << usage.bytes[GpuMemory::Textures]
+            << ",\"renderbufferBytes\":" << usage.bytes[GpuMemory::Renderbuffers] << '}';
+    }
+    file << "]}\n";
+    return bool(file);
+}
@@ -0,0 +1,146 @@
+#include <engine/frame-streamer.hpp>
+#include <cstdio>
+#include <iostream>
+#include <utils/sockets.hpp>
+
+using Clock = std::chrono::steady_clock;
+
+// a client that does not take a frame in this time is disconnected
+static constexpr int clientTimeoutMs = 1000;
+
+static double toKiB(double bytes) {
+    return bytes / 1024.0;
+}
+
+static void printStats(const char* title, const FrameStreamer::Stats& stats, size_t clients) {
+    if(stats.frames == 0) {
+        return;
+    }
+
+    const double frames = double(stats.frames);
+    // clears the fps line before
+    printf("\r%64s\r> %s (%zu clients)\n", "", title, clients);
+    printf(
+        "    encode %7llu  p50 %7.2fms  p90 %7.2fms  p99 %7.2fms  max %7.2fms\n",
+        (unsigned long long) stats.frames,
+        stats.encodeTimes.percentile(50.0),
+        stats.encodeTimes.percentile(90.0),
+        stats.encodeTimes.percentile(99.0),
+        stats.encodeTimes.max()
+    );
+    printf(
+        "    bytes per frame %.1f KiB (raw %.1f KiB, %.1f%%)  changed tiles per frame %.1f\n",
+        toKiB(stats.bytes / frames),
+        toKiB(stats.rawBytes / frames),
+        stats.rawBytes ? 100.0 * double(stats.bytes) / double(stats.rawBytes) : 0.0,
+        stats.changedTiles / frames
+    );
+    fflush(stdout);
+}
+
+FrameStreamer::FrameStreamer(const std::string& address, double reportInterval):
+    address(address),
+    reportInterval(reportInterval),
+    intervalStart(Clock::now()) {}
+
+FrameStreamer::~FrameStreamer() {
+    stopping = true;
+    newFrameCondition.notify_one();
+    if(worker.joinable()) {
+        worker.join();
+    }
+
+    for(intptr_t client : clients) {
+        closeSocket(client);
+    }
+
+    if(listenSocket != invalidSocket) {
+        closeListenSocket(listenSocket, address);
+        printStats("Stream stats of the whole run", totalStats, clients.size());
+    }
+}
+
+bool FrameStreamer::start() {
+    listenSocket = openListenSocket(address, "stream");
+    if(listenSocket == invalidSocket) {
+        return false;
+    }
+
+    worker = std::thread([this] () { run(); });
+    std::cout << "> Streaming frames in " << address << std::endl;
+    return true;
+}
+
+void FrameStreamer::frameReady() {
+    frames.publish();
+    {
+        std::lock_guard<std::mutex> lock(newFrameMutex);
+        newFrame = true;
+    }
+    newFrameCondition.notify_one();
+}
+
+void FrameStreamer::run() {
+    bool keyframe = true;
+    while(!stopping) {
+        acceptClients(keyframe);
+
+        // waits with a timeout to accept the clients and to check if the streamer is stopping
+        {
+            std::unique_lock<std::mutex> lock(newFrameMutex);
+            newFrameCondition.wait_for(lock, std::chrono::milliseconds(50), [this] () { return newFrame || stopping; });
+            newFrame = false;
+        }
+
+        if(!frames.update() || clients.empty()) {
+            continue;
+        }
+
+        sendFrame(frames.read(), keyframe);
+        keyframe = false;
+
+        const auto now = Clock::now();
+        if(reportInterval > 0.0 && now - intervalStart >= std::chrono::duration<double>(reportInterval)) {
+            printStats("Stream stats", intervalStats, clients.size());
+            intervalStats = {};
+            intervalStart = now;
+        }
+    }
+}
+
+void FrameStreamer::acceptClients(bool& keyframe) {
+    for(intptr_t client = acceptConnection(listenSocket, 0); client != invalidSocket; client = acceptConnection(listenSocket, 0)) {
+        setSocketTimeout(client, clientTimeoutMs);
+        clients.push_back(client);
+        // the new client needs all the tiles (the others receive them too, it is simpler than a frame for each one)
+        keyframe = true;
+        printf("\r%64s\r> Stream client connected (%zu clients)\n", "", clients.size());
+        fflush(stdout);
+    }
+}
+
+void FrameStreamer::sendFrame(const Frame& frame, bool keyframe) {
+    const auto encodeStart = Clock::now();
+    const size_t bytes = encoder.encode(frame.pixels.data(), frame.size, frame.number, keyframe, encoded);
+    const double encodeMs = std::chrono::duration<double, std::milli>(Clock::now() - encodeStart).count();
+
+    for(auto client = clients.begin(); client != clients.end();) {
+        if(sendAll(*client, encoded.data(), bytes)) {
+            ++client;
+            continue;
+        }
+
+        closeSocket(*client);
+        client = clients.erase(client);
+        printf("\r%64s\r> Stream client disconnected (%zu clients)\n", "", clients.size());
+        fflush(stdout);
+    }
+
+    for(Stats* stats : { &intervalStats, &totalStats }) {
+        stats->encodeTimes.record(encodeMs);
+        stats->frames += 1;
+        stats->bytes += bytes;
+        stats->rawBytes += frame.pixels.size();
+        stats->changedTiles += encoder.lastChangedTiles();
+    }
+}
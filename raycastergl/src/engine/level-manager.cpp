@@ -0,0 +1,226 @@
+#include <engine/level-manager.hpp>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <utils/files.hpp>
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+LevelManager::LevelManager() {
+    worker = std::thread([this] () { run(); });
+}
+
+LevelManager::~LevelManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wakeUp.notify_one();
+    worker.join();
+}
+
+void LevelManager::run() {
+    while(true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this] () { return stopping || !jobs.empty(); });
+            // the pending jobs are finished before stopping, so the previous maps are always freed
+            if(jobs.empty()) {
+                return;
+            }
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        job();
+    }
+}
+
+void LevelManager::push(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+
+    wakeUp.notify_one();
+}
+
+std::shared_ptr<const PotentiallyVisibleSet> LevelManager::visibilityOf(const fs::path& path, const MapGrid& grid) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto cached = visibilityCache.find(path);
+        if(cached != visibilityCache.end()) {
+            return cached->second;
+        }
+    }
+
+    auto visibility = PotentiallyVisibleSet::build(grid, &threads);
+    std::lock_guard<std::mutex> lock(mutex);
+    visibilityCache[path] = visibility;
+    return visibility;
+}
+
+bool LevelManager::load(const fs::path& path) {
+    const auto start = Clock::now();
+    currentMap = Map::load(path);
+    currentPath = path;
+    if(currentMap != std::nullopt) {
+        currentMap->visibility = visibilityOf(path, currentMap->data);
+    }
+    currentLoadMs = elapsedMs(start);
+    loadedMaps += currentMap != std::nullopt;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        visibilityMap = loadedMaps;
+        visibilityVersion = 0;
+    }
+    return currentMap != std::nullopt;
+}
+
+void LevelManager::preload(const fs::path& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(loading) {
+            return;
+        }
+
+        loading = true;
+    }
+
+    push([this, path] () {
+        const auto start = Clock::now();
+        // an exception would end the worker thread (and the game), a bad map only fails the preload
+        std::optional<Map> map;
+        try {
+            map = Map::parse(path);
+            if(map != std::nullopt) {
+                map->visibility = visibilityOf(path, map->data);
+            }
+        } catch(const std::exception& e) {
+            std::cerr << "  Map could not be preloaded: " << e.what() << std::endl;
+            map = std::nullopt;
+        }
+        const double parseMs = elapsedMs(start);
+        std::lock_guard<std::mutex> lock(mutex);
+        loading = false;
+        if(map == std::nullopt) {
+            return;
+        }
+
+        preloadedMap = std::move(map);
+        preloadedPath = path;
+        preloadedParseMs = parseMs;
+    });
+}
+
+void LevelManager::preloadNext() {
+    std::vector<fs::path> maps;
+    for(const auto& entry : fs::directory_iterator(resourcePath("maps"))) {
+        if(entry.is_regular_file() && entry.path().extension() == ".yaml") {
+            maps.push_back(entry.path().filename());
+        }
+    }
+
+    if(maps.empty()) {
+        return;
+    }
+
+    std::sort(maps.begin(), maps.end());
+    auto next = std::upper_bound(maps.begin(), maps.end(), currentPath);
+    preload(next == maps.end() ? maps.front() : *next);
+}
+
+bool LevelManager::swapIfReady() {
+    std::optional<Map> map;
+    fs::path path;
+    double parseMs;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(preloadedMap == std::nullopt) {
+            return false;
+        }
+
+        map.swap(preloadedMap);
+        path = std::move(preloadedPath);
+        parseMs = preloadedParseMs;
+    }
+
+    // the OpenGL objects can only be created and destroyed in this thread, the rest of the
+    // previous map (the arena) is freed by the worker, its texture goes to the pool first so the new map can reuse it
+    const auto textureStart = Clock::now();
+    if(currentMap != std::nullopt) {
+        currentMap->releaseGpuObjects(pool);
+        auto previousMap = std::make_shared<Map>(std::move(*currentMap));
+        push([previousMap] () mutable { previousMap.reset(); });
+    }
+    map->createTexture(&pool);
+    const double textureMs = elapsedMs(textureStart);
+
+    currentMap = std::move(map);
+    currentPath = path;
+    currentLoadMs = parseMs + textureMs;
+    loadedMaps += 1;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        visibilityMap = loadedMaps;
+        visibilityVersion = currentMap->cellsVersion;
+    }
+    std::cout << "\r> Changed map to " << currentPath << std::endl;
+    return true;
+}
+
+void LevelManager::updateVisibility() {
+    if(currentMap == std::nullopt) {
+        return;
+    }
+
+    Map& map = *currentMap;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(rebuiltVisibility && rebuiltMap == loadedMaps && rebuiltVersion == map.cellsVersion) {
+            map.visibility = std::move(rebuiltVisibility);
+        }
+        rebuiltVisibility = nullptr;
+
+        if(map.visibility || (visibilityMap == loadedMaps && visibilityVersion == map.cellsVersion)) {
+            return;
+        }
+
+        visibilityMap = loadedMaps;
+        visibilityVersion = map.cellsVersion;
+    }
+
+    // the worker builds it from a copy of the walls, the map can change again meanwhile
+    auto grid = std::make_shared<MapGrid>(map.data, nullptr);
+    push([this, grid, builtMap = loadedMaps, builtVersion = map.cellsVersion] () {
+        {
+            // the walls changed again before the worker got here, a newer job builds it
+            std::lock_guard<std::mutex> lock(mutex);
+            if(visibilityMap != builtMap || visibilityVersion != builtVersion) {
+                return;
+            }
+        }
+
+        // without a set the spriteculler keeps getting every entity, until the walls change again
+        std::shared_ptr<const PotentiallyVisibleSet> visibility;
+        try {
+            visibility = PotentiallyVisibleSet::build(*grid, &threads);
+        } catch(const std::exception& e) {
+            std::cerr << "  Potentially visible set could not be built: " << e.what() << std::endl;
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        rebuiltVisibility = std::move(visibility);
+        rebuiltMap = builtMap;
+        rebuiltVersion = builtVersion;
+    });
+}
@@ -0,0 +1,26 @@
+#include <engine/map-grid.hpp>
+#include <algorithm>
+#include <cstring>
+
+MapGrid::MapGrid(glm::uvec2 size, Arena* arena): cells(ArenaAllocator<uint8_t>(arena)), gridSize(size) {
+    // the last tiles are filled with empty cells
+    tilesY = (size.y + tileMask) >> tileBits;
+    cells.resize(storageSize(size), 0);
+}
+
+size_t MapGrid::storageSize(glm::uvec2 size) {
+    size_t tilesX = (size.x + tileMask) >> tileBits;
+    size_t tilesY = (size.y + tileMask) >> tileBits;
+    return tilesX * tilesY * tileSize * tileSize;
+}
+
+void MapGrid::copyRow(size_t x, size_t y, size_t count, uint8_t* output) const {
+    // the cells of a row are contiguous inside a tile
+    while(count > 0) {
+        size_t cellsInTile = std::min<size_t>(tileSize - (y & tileMask), count);
+        memcpy(output, &cells[index(x, y)], cellsInTile);
+        output += cellsInTile;
+        y += cellsInTile;
+        count -= cellsInTile;
+    }
+}
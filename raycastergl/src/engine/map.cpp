@@ -1,27 +1,204 @@
 #include <engine/map.hpp>
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <streambuf>
 #include <glad/glad.h>
+#include <glm/common.hpp>
 #include <yaml-cpp/yaml.h>
 #include <opengl/check-error.hpp>
+#include <utils/files.hpp>
 
-void Map::destroy() {
-    delete[] data;
+// lets the yaml parser read the mapped file directly, without copying it into a string
+struct MappedFileBuffer: std::streambuf {
+    explicit MappedFileBuffer(const MappedFile& file) {
+        char* start = (char*) file.data();
+        setg(start, start, start + file.size());
+    }
+};
+
+// above this, the rectangles are merged into one: many small uploads cost more than some extra cells
+static constexpr size_t maxDirtyRects = 8;
+
+// rows of the texture uploads are aligned to 4 bytes (the default GL_UNPACK_ALIGNMENT)
+static inline size_t uploadRowPitch(uint32_t width) {
+    return (width + 3) & ~size_t(3);
 }
 
-std::optional<Map> Map::load(const fs::path& path) {
-    fs::path fullPath = fs::path("res/maps") / path;
-    std::cout << "> Loading map " << path << std::endl;
-    if(!fs::exists(fullPath)) {
-        std::cerr << "  Map does not exist!" << std::endl;
-        return std::nullopt;
+static inline size_t uploadSize(const MapRect& rect) {
+    return uploadRowPitch(rect.end.y - rect.start.y) * (rect.end.x - rect.start.x);
+}
+
+static MapRect boundingRect(const vector<MapRect>& rects) {
+    MapRect bounds = rects.front();
+    for(const auto& rect : rects) {
+        bounds.start = glm::min(bounds.start, rect.start);
+        bounds.end = glm::max(bounds.end, rect.end);
     }
+    return bounds;
+}
 
-    if(!fs::is_regular_file(fullPath)) {
-        std::cerr << "  Map is not a file!" << std::endl;
-        return std::nullopt;
+void Map::set(size_t x, size_t y, uint8_t value) {
+    uint8_t& cell = data.at(x, y);
+    if(cell == value) {
+        return;
+    }
+
+    cell = value;
+    markChanged({ uvec2(x, y), uvec2(x + 1, y + 1) });
+}
+
+void Map::markChanged(const MapRect& changed) {
+    visibility = nullptr;
+    cellsVersion += 1;
+
+    // the cells are added to a rectangle that touches them, so nearby changes (like a door) are uploaded together
+    for(auto& rect : dirtyRects) {
+        bool touchesX = changed.start.x <= rect.end.x && rect.start.x <= changed.end.x;
+        bool touchesY = changed.start.y <= rect.end.y && rect.start.y <= changed.end.y;
+        if(touchesX && touchesY) {
+            rect.start = glm::min(rect.start, changed.start);
+            rect.end = glm::max(rect.end, changed.end);
+            return;
+        }
+    }
+
+    dirtyRects.push_back(changed);
+    if(dirtyRects.size() > maxDirtyRects) {
+        dirtyRects = { boundingRect(dirtyRects) };
+    }
+}
+
+void Map::uploadChanges() {
+    if(dirtyRects.empty()) {
+        return;
+    }
+
+    // the staging buffer can hold the whole map, if the rectangles do not fit, the bounding one always does
+    const size_t stagingSize = uploadRowPitch(size.y) * size.x;
+    if(!stagingBuffer) {
+        stagingBuffer = std::make_shared<Buffer>(Buffer::PixelUnpackBuffer, stagingSize, Buffer::StreamDraw);
+        stagingBuffer->setTag("map staging");
+    }
+
+    size_t totalSize = 0;
+    for(const auto& rect : dirtyRects) {
+        totalSize += uploadSize(rect);
+    }
+    if(totalSize > stagingSize) {
+        dirtyRects = { boundingRect(dirtyRects) };
+        totalSize = uploadSize(dirtyRects.front());
+    }
+
+    // copies the rows of each rectangle one after the other
+    stagingBuffer->mapForOverwrite(totalSize, [this] (void* ptr) {
+        uint8_t* staging = (uint8_t*) ptr;
+        for(const auto& rect : dirtyRects) {
+            const uint32_t width = rect.end.y - rect.start.y;
+            for(uint32_t x = rect.start.x; x < rect.end.x; x += 1) {
+                data.copyRow(x, rect.start.y, width, staging);
+                staging += uploadRowPitch(width);
+            }
+        }
+    });
+
+    // the texture is transposed: x of the map is y in the texture
+    texture->bind();
+    stagingBuffer->bind();
+    size_t offset = 0;
+    for(const auto& rect : dirtyRects) {
+        texture->fillSubImage2D(
+            0,
+            ivec2(rect.start.y, rect.start.x),
+            ivec2(rect.end.y - rect.start.y, rect.end.x - rect.start.x),
+            Texture::RedInteger,
+            Texture::UnsignedByte,
+            (const void*) offset
+        );
+        offset += uploadSize(rect);
+    }
+
+    // other texture uploads read from client memory
+    Buffer::unbind(Buffer::PixelUnpackBuffer);
+    dirtyRects.clear();
+}
+
+Shader::Defines Map::shaderDefines() const {
+    Shader::Defines defines;
+    if(std::holds_alternative<uint32_t>(floor)) {
+        defines["FLOOR_TEXTURED"] = "1";
+    }
+    if(std::holds_alternative<uint32_t>(ceil)) {
+        defines["CEIL_TEXTURED"] = "1";
+    }
+    return defines;
+}
+
+vector<Shader::Defines> Map::allShaderDefines() {
+    vector<Shader::Defines> variants;
+    for(bool floorTextured : { false, true }) {
+        for(bool ceilTextured : { false, true }) {
+            Map map;
+            map.floor = floorTextured ? std::variant<uint32_t, vec3>(0u) : vec3(0.f);
+            map.ceil = ceilTextured ? std::variant<uint32_t, vec3>(0u) : vec3(0.f);
+            variants.push_back(map.shaderDefines());
+        }
+    }
+    return variants;
+}
+
+void Map::createTexture(GpuPool* pool) {
+    const ivec2 textureSize(size.y, size.x);
+    if(pool) {
+        texture = pool->acquireTexture2D(Texture::R8UI, textureSize, "map");
+        stagingBuffer = pool->acquireBuffer(Buffer::PixelUnpackBuffer, uploadRowPitch(size.y) * size.x, "map staging");
     }
 
-    auto mapYaml = YAML::LoadFile(fullPath.string());
+    if(texture) {
+        // same size and format, only the contents change
+        texture->bind();
+        texture->fillSubImage2D(0, ivec2(0, 0), textureSize, Texture::RedInteger, Texture::UnsignedByte, textureData.data());
+    } else {
+        texture = std::make_shared<Texture>(Texture::Type::_2D);
+        texture->setTag("map");
+        texture->bind();
+        texture->setWrap(Texture::Repeat, Texture::Repeat);
+        texture->setMinFilter(Texture::Nearest);
+        texture->setMagFilter(Texture::Nearest);
+        texture->fillImage2D(
+            0,
+            Texture::R8UI,
+            textureSize,
+            0,
+            Texture::RedInteger,
+            Texture::UnsignedByte,
+            textureData.data()
+        );
+    }
+
+    // the memory stays in the arena, but the texture data is not needed anymore
+    textureData = decltype(textureData)(ArenaAllocator<uint8_t>(arena.get()));
+}
+
+void Map::releaseGpuObjects(GpuPool& pool) {
+    pool.release(std::move(texture));
+    pool.release(std::move(stagingBuffer));
+    texture = nullptr;
+    stagingBuffer = nullptr;
+}
+
+std::optional<Map> Map::load(const fs::path& path) {
+    auto map = parse(path);
+    if(map != std::nullopt) {
+        std::cout << "  > Loading map texture" << std::endl;
+        map->createTexture();
+    }
+
+    return map;
+}
+
+// the map of a parsed file, yaml-cpp throws if a property is missing or has another type
+static std::optional<Map> fromYaml(const YAML::Node& mapYaml) {
     if(!mapYaml["map"]) {
         std::cerr << "  Map file is invalid: does not have map property" << std::endl;
         return std::nullopt;
@@ -30,10 +207,25 @@ std::optional<Map> Map::load(const fs::path& path) {
     std::cout << "  > Loading map data" << std::endl;
     uint32_t mapWidth = mapYaml["map"]["width"].as<uint32_t>();
     uint32_t mapHeight = mapYaml["map"]["height"].as<uint32_t>();
-    uint8_t* map = new uint8_t[mapWidth * mapHeight];
+    if(mapWidth == 0 || mapHeight == 0 || mapWidth > MapGrid::maxSide || mapHeight > MapGrid::maxSide) {
+        std::cerr << "  Map file is invalid: the size must be between 1 and " << MapGrid::maxSide << " cells" << std::endl;
+        return std::nullopt;
+    }
+
+    // everything that lives as long as the map goes into one allocation (with some room for the alignment)
+    const size_t arenaSize = MapGrid::storageSize(uvec2(mapWidth, mapHeight))
+        + uploadRowPitch(mapHeight) * mapWidth
+        + 2 * alignof(std::max_align_t);
+    auto arena = std::make_shared<Arena>(arenaSize);
+
+    MapGrid grid(uvec2(mapWidth, mapHeight), arena.get());
+    // the texture is uploaded in rows of x (see Map::at)
+    vector<uint8_t, ArenaAllocator<uint8_t>> textureData(uploadRowPitch(mapHeight) * mapWidth, 0, arena.get());
+    const auto content = mapYaml["map"]["content"];
     for(uint32_t x = 0; x < mapWidth; x += 1) {
+        const auto row = content[x];
         for(uint32_t y = 0; y < mapHeight; y += 1) {
-            map[x * mapWidth + y] = mapYaml["map"]["content"][x][y].as<uint16_t>() & 0xFF;
+            grid.at(x, y) = textureData[x * uploadRowPitch(mapHeight) + y] = row[y].as<uint16_t>() & 0xFF;
         }
     }
 
@@ -72,47 +264,61 @@ std::optional<Map> Map::load(const fs::path& path) {
     );
 
     std::cout << "  > Loading sprites data" << std::endl;
-    size_t spriteCount = mapYaml["sprites"].size();
-    std::vector<Sprite> sprites;
-    for(uint32_t i = 0; i < spriteCount; i += 1) {
+    Map mapData;
+    for(const auto& spriteYaml : mapYaml["sprites"]) {
         Sprite sprite = {
-            mapYaml["sprites"][i]["x"].as<float>(),
-            mapYaml["sprites"][i]["y"].as<float>(),
-            mapYaml["sprites"][i]["texture"].as<uint32_t>(),
-            mapYaml["sprites"][i]["uDiv"].as<int32_t>(1),
-            mapYaml["sprites"][i]["vDiv"].as<int32_t>(1),
-            mapYaml["sprites"][i]["vMove"].as<float>(0.0f),
+            spriteYaml["x"].as<float>(),
+            spriteYaml["y"].as<float>(),
+            spriteYaml["texture"].as<uint32_t>(),
+            spriteYaml["uDiv"].as<int32_t>(1),
+            spriteYaml["vDiv"].as<int32_t>(1),
+            spriteYaml["vMove"].as<float>(0.0f),
+            0,
         };
-        sprites.push_back(sprite);
-    }
-
-    std::cout << "  > Loading map texture" << std::endl;
-    Map mapData {
-        map,
-        uvec2(mapWidth, mapHeight),
-        floor,
-        ceil,
-        initialPos,
-        initialDir,
-        initialPlane,
-        sprites,
-        std::make_shared<Texture>(Texture::Type::_2D),
-    };
-
-    mapData.texture->bind();
-    mapData.texture->setWrap(Texture::Repeat, Texture::Repeat);
-    mapData.texture->setMinFilter(Texture::Nearest);
-    mapData.texture->setMagFilter(Texture::Nearest);
-
-    mapData.texture->fillImage2D(
-        0,
-        Texture::R8UI,
-        { mapWidth, mapHeight },
-        0,
-        Texture::RedInteger,
-        Texture::UnsignedByte,
-        map
-    );
+        mapData.entities.create(sprite, std::max(spriteYaml["radius"].as<float>(defaultSpriteRadius), 0.0f));
+    }
 
+    mapData.arena = std::move(arena);
+    mapData.data = std::move(grid);
+    mapData.size = uvec2(mapWidth, mapHeight);
+    mapData.floor = floor;
+    mapData.ceil = ceil;
+    mapData.initialPos = initialPos;
+    mapData.initialDir = initialDir;
+    mapData.initialPlane = initialPlane;
+    mapData.textureData = std::move(textureData);
     return mapData;
 }
+
+std::optional<Map> Map::parse(const fs::path& path) {
+    fs::path fullPath = resourcePath("maps") / path;
+    std::cout << "> Loading map " << path << std::endl;
+    if(!fs::exists(fullPath)) {
+        std::cerr << "  Map does not exist!" << std::endl;
+        return std::nullopt;
+    }
+
+    if(!fs::is_regular_file(fullPath)) {
+        std::cerr << "  Map is not a file!" << std::endl;
+        return std::nullopt;
+    }
+
+    auto mapFile = MappedFile::open(fullPath);
+    if(mapFile == std::nullopt) {
+        std::cerr << "  Map could not be read!" << std::endl;
+        return std::nullopt;
+    }
+
+    MappedFileBuffer mapBuffer(*mapFile);
+    std::istream mapStream(&mapBuffer);
+    // yaml-cpp throws on malformed files, and the map fails to load instead of ending the game
+    try {
+        return fromYaml(YAML::Load(mapStream));
+    } catch(const YAML::Exception& e) {
+        std::cerr << "  Map file is invalid: " << e.what() << std::endl;
+    } catch(const std::exception& e) {
+        std::cerr << "  Map could not be loaded: " << e.what() << std::endl;
+    }
+
+    return std::nullopt;
+}
@@ -0,0 +1,176 @@
+#include <engine/metrics-exporter.hpp>
+#include <cstdio>
+#include <iostream>
+#include <utils/sockets.hpp>
+
+using Clock = std::chrono::steady_clock;
+
+static const char* const gpuPassNames[MetricsExporter::GpuPassCount] = {
+    "raycaster",
+    "depthreducer",
+    "spriteculler",
+    "spritecaster",
+    "floorcaster",
+    "drawer",
+};
+
+MetricsExporter::MetricsExporter(const std::string& address): address(address), lastPublish(Clock::now()) {}
+
+MetricsExporter::~MetricsExporter() {
+    stopping = true;
+    if(worker.joinable()) {
+        worker.join();
+    }
+
+    if(listenSocket != invalidSocket) {
+        closeListenSocket(listenSocket, address);
+    }
+}
+
+bool MetricsExporter::start() {
+    listenSocket = openListenSocket(address, "metrics");
+    if(listenSocket == invalidSocket) {
+        return false;
+    }
+
+    worker = std::thread([this] () { run(); });
+    std::cout << "> Serving metrics in " << address << std::endl;
+    return true;
+}
+
+void MetricsExporter::frameFinished(double frameMs) {
+    frameTimes.record(frameMs);
+    pending.frames += 1;
+    pending.frameSumMs += frameMs;
+
+    const auto now = Clock::now();
+    if(now - lastPublish < std::chrono::seconds(1)) {
+        return;
+    }
+
+    pending.frameP50Ms = frameTimes.percentile(50.0);
+    pending.frameP90Ms = frameTimes.percentile(90.0);
+    pending.frameP99Ms = frameTimes.percentile(99.0);
+    pending.frameMaxMs = frameTimes.max();
+    pending.hasGpuPasses = gpuPassSamples > 0;
+    for(size_t i = 0; i < GpuPassCount; i++) {
+        pending.gpuPassMs[i] = gpuPassSamples > 0 ? gpuPassSums[i] / gpuPassSamples : 0.0;
+    }
+
+    samples.writeSlot() = pending;
+    samples.publish();
+
+    frameTimes.reset();
+    gpuPassSums.fill(0.0);
+    gpuPassSamples = 0;
+    lastPublish = now;
+}
+
+void MetricsExporter::gpuPassesMeasured(const std::vector<double>& passesMs) {
+    for(size_t i = 0; i < GpuPassCount && i < passesMs.size(); i++) {
+        gpuPassSums[i] += passesMs[i];
+    }
+
+    gpuPassSamples += 1;
+}
+
+void MetricsExporter::run() {
+    while(!stopping) {
+        // waits with a timeout to check if the exporter is stopping
+        intptr_t client = acceptConnection(listenSocket, 250);
+        if(client == invalidSocket) {
+            continue;
+        }
+
+        // the request is not needed (any path returns the metrics), but it is read until the end of
+        // the headers so the client does not get a reset
+        setSocketTimeout(client, 1000);
+        std::string request;
+        char buffer[1024];
+        while(request.size() < 8192 && request.find("\r\n\r\n") == std::string::npos) {
+            auto received = receiveSome(client, buffer, sizeof(buffer));
+            if(received <= 0) {
+                break;
+            }
+            request.append(buffer, size_t(received));
+        }
+
+        samples.update();
+        const std::string body = format(samples.read());
+        const std::string response =
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Connection: close\r\n"
+            "\r\n" + body;
+        sendAll(client, response.data(), response.size());
+        closeSocket(client);
+    }
+}
+
+std::string MetricsExporter::format(const Sample& sample) const {
+    std::string text;
+    char line[256];
+    auto metric = [&text] (const char* name, const char* type, const char* help) {
+        text += "# HELP ";
+        text += name;
+        text += ' ';
+        text += help;
+        text += "\n# TYPE ";
+        text += name;
+        text += ' ';
+        text += type;
+        text += '\n';
+    };
+
+    metric("raycastergl_frame_time_seconds", "summary", "Time between two frames (the quantiles are of the last second)");
+    snprintf(
+        line,
+        sizeof(line),
+        "raycastergl_frame_time_seconds{quantile=\"0.5\"} %.6f\n"
+        "raycastergl_frame_time_seconds{quantile=\"0.9\"} %.6f\n"
+        "raycastergl_frame_time_seconds{quantile=\"0.99\"} %.6f\n",
+        sample.frameP50Ms / 1000.0,
+        sample.frameP90Ms / 1000.0,
+        sample.frameP99Ms / 1000.0
+    );
+    text += line;
+    snprintf(line, sizeof(line), "raycastergl_frame_time_seconds_sum %.6f\n", sample.frameSumMs / 1000.0);
+    text += line;
+    snprintf(line, sizeof(line), "raycastergl_frame_time_seconds_count %llu\n", (unsigned long long) sample.frames);
+    text += line;
+
+    metric("raycastergl_frame_time_max_seconds", "gauge", "Longest frame of the last second");
+    snprintf(line, sizeof(line), "raycastergl_frame_time_max_seconds %.6f\n", sample.frameMaxMs / 1000.0);
+    text += line;
+
+    if(sample.hasGpuPasses) {
+        metric("raycastergl_gpu_pass_seconds", "gauge", "GPU time of each pass (average of the last second)");
+        for(size_t i = 0; i < GpuPassCount; i++) {
+            snprintf(line, sizeof(line), "raycastergl_gpu_pass_seconds{pass=\"%s\"} %.6f\n", gpuPassNames[i], sample.gpuPassMs[i] / 1000.0);
+            text += line;
+        }
+    }
+
+    metric("raycastergl_sprites", "gauge", "Sprites in the map");
+    snprintf(line, sizeof(line), "raycastergl_sprites %u\n", sample.sprites);
+    text += line;
+    metric("raycastergl_visible_sprites", "gauge", "Sprites left after the culling");
+    snprintf(line, sizeof(line), "raycastergl_visible_sprites %u\n", sample.visibleSprites);
+    text += line;
+
+    metric("raycastergl_texture_memory_bytes", "gauge", "Memory reserved for the textures in the GPU");
+    snprintf(line, sizeof(line), "raycastergl_texture_memory_bytes %llu\n", (unsigned long long) sample.textureBytes);
+    text += line;
+    metric("raycastergl_buffer_memory_bytes", "gauge", "Memory reserved for the buffers in the GPU");
+    snprintf(line, sizeof(line), "raycastergl_buffer_memory_bytes %llu\n", (unsigned long long) sample.bufferBytes);
+    text += line;
+
+    metric("raycastergl_map_load_seconds", "gauge", "Time to load the current map (parse and texture upload)");
+    snprintf(line, sizeof(line), "raycastergl_map_load_seconds %.6f\n", sample.mapLoadMs / 1000.0);
+    text += line;
+    metric("raycastergl_map_loads_total", "counter", "Maps loaded since the start");
+    snprintf(line, sizeof(line), "raycastergl_map_loads_total %u\n", sample.mapLoads);
+    text += line;
+    return text;
+}
@@ -0,0 +1,249 @@
+#include <engine/potentially-visible-set.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+// the rays start from points along the sides of the cell: a line from anywhere in the cell leaves it through
+// a side, so what is seen from inside is seen from the sides. They are a bit inside the cell, where the rays
+// do not go through the corners of the cells
+static constexpr uint32_t pointsPerSide = 6;
+static constexpr float sideInset = 0.01f;
+// a wedge between two rays is not split again when their ends are nearer than this (or after these splits)
+static constexpr float minWedgeGap = 1.0f / 64.0f;
+static constexpr uint32_t maxWedgeSplits = 24;
+
+// where a ray stopped: the wall cell (or the first cell outside of the map) and the point where it entered it
+struct RayEnd {
+    glm::ivec2 cell;
+    glm::vec2 point;
+    bool outside;
+};
+
+static inline bool isEmpty(const MapGrid& grid, int32_t x, int32_t y) {
+    return grid.at(x, y) == 0;
+}
+
+// walks the cells crossed by the ray (a DDA, as in the raycaster) and marks them, up to the first wall
+static RayEnd castRay(const MapGrid& grid, glm::vec2 origin, glm::vec2 dir, std::vector<uint8_t>& visible) {
+    const glm::uvec2 size = grid.size();
+    glm::ivec2 cell(int32_t(origin.x), int32_t(origin.y));
+    const glm::vec2 delta(
+        dir.x == 0.0f ? INFINITY : std::abs(1.0f / dir.x),
+        dir.y == 0.0f ? INFINITY : std::abs(1.0f / dir.y)
+    );
+    const glm::ivec2 step(dir.x < 0.0f ? -1 : 1, dir.y < 0.0f ? -1 : 1);
+    glm::vec2 sideDist(
+        (dir.x < 0.0f ? origin.x - cell.x : cell.x + 1.0f - origin.x) * delta.x,
+        (dir.y < 0.0f ? origin.y - cell.y : cell.y + 1.0f - origin.y) * delta.y
+    );
+
+    while(true) {
+        float distance;
+        if(sideDist.x < sideDist.y) {
+            distance = sideDist.x;
+            sideDist.x += delta.x;
+            cell.x += step.x;
+        } else {
+            distance = sideDist.y;
+            sideDist.y += delta.y;
+            cell.y += step.y;
+        }
+
+        const glm::vec2 point(origin.x + dir.x * distance, origin.y + dir.y * distance);
+        if(cell.x < 0 || cell.y < 0 || uint32_t(cell.x) >= size.x || uint32_t(cell.y) >= size.y) {
+            return { cell, point, true };
+        }
+
+        visible[size_t(cell.x) * size.y + cell.y] = 1;
+        if(!isEmpty(grid, cell.x, cell.y)) {
+            return { cell, point, false };
+        }
+    }
+}
+
+static inline glm::vec2 normalized(glm::vec2 v) {
+    const float length = std::sqrt(v.x * v.x + v.y * v.y);
+    return glm::vec2(v.x / length, v.y / length);
+}
+
+// the rays of a wedge can stop in different walls while something behind them is seen through the gap
+// between the walls, so the wedge is split until nothing can be seen between its rays: both end in the same
+// wall or in two walls side by side (the line between the ends crosses only walls), or both leave the map
+static void castWedge(const MapGrid& grid, glm::vec2 origin, glm::vec2 dirA, const RayEnd& endA, glm::vec2 dirB, const RayEnd& endB, std::vector<uint8_t>& visible, uint32_t splits) {
+    const glm::ivec2 cells(std::abs(endA.cell.x - endB.cell.x), std::abs(endA.cell.y - endB.cell.y));
+    const glm::vec2 gap(endA.point.x - endB.point.x, endA.point.y - endB.point.y);
+    if((endA.outside && endB.outside) || cells.x + cells.y <= 1 || gap.x * gap.x + gap.y * gap.y < minWedgeGap * minWedgeGap || splits == 0) {
+        return;
+    }
+
+    const glm::vec2 a = normalized(dirA), b = normalized(dirB);
+    const glm::vec2 dirMiddle(a.x + b.x, a.y + b.y);
+    const RayEnd endMiddle = castRay(grid, origin, dirMiddle, visible);
+    castWedge(grid, origin, dirA, endA, dirMiddle, endMiddle, visible, splits - 1);
+    castWedge(grid, origin, dirMiddle, endMiddle, dirB, endB, visible, splits - 1);
+}
+
+// unsigned LEB128, most runs are shorter than 128 cells and take one byte
+static void writeVarint(std::vector<uint8_t>& output, uint32_t value) {
+    while(value >= 0x80) {
+        output.push_back(uint8_t(value | 0x80));
+        value >>= 7;
+    }
+    output.push_back(uint8_t(value));
+}
+
+static uint32_t readVarint(const uint8_t*& input) {
+    uint32_t value = 0;
+    for(uint32_t shift = 0;; shift += 7) {
+        const uint8_t byte = *input++;
+        value |= uint32_t(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) {
+            return value;
+        }
+    }
+}
+
+// the cells are a bitset compressed as the lengths of the runs, starting with a run of hidden cells
+// (that can be empty) and then alternating visible and hidden runs, until the end of the map
+static void encode(const std::vector<uint8_t>& visible, std::vector<uint8_t>& output) {
+    uint8_t current = 0;
+    uint32_t length = 0;
+    for(uint8_t value : visible) {
+        if(value != current) {
+            writeVarint(output, length);
+            current = value;
+            length = 0;
+        }
+        length += 1;
+    }
+    writeVarint(output, length);
+}
+
+std::shared_ptr<const PotentiallyVisibleSet> PotentiallyVisibleSet::build(const MapGrid& grid, ThreadPool* pool) {
+    const glm::uvec2 size = grid.size();
+    const size_t cellCount = size_t(size.x) * size.y;
+    if(cellCount == 0 || cellCount > maxCells) {
+        std::cout << "> The map is too big for a potentially visible set (" << size.x << "x" << size.y << " cells)" << std::endl;
+        return nullptr;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    // the first rays go to every corner of the cells in the border of the map, in order around it: two
+    // neighbouring rays end one cell apart, and every cell is nearer than the border in its direction, so
+    // no cell fits between two rays (before they stop, see castWedge)
+    std::vector<glm::vec2> targets;
+    targets.reserve(2 * (size.x + size.y));
+    for(uint32_t x = 0; x < size.x; x += 1) {
+        targets.emplace_back(float(x), 0.0f);
+    }
+    for(uint32_t y = 0; y < size.y; y += 1) {
+        targets.emplace_back(float(size.x), float(y));
+    }
+    for(uint32_t x = size.x; x > 0; x -= 1) {
+        targets.emplace_back(float(x), float(size.y));
+    }
+    for(uint32_t y = size.y; y > 0; y -= 1) {
+        targets.emplace_back(0.0f, float(y));
+    }
+
+    std::vector<std::vector<uint8_t>> encoded(cellCount);
+    const auto buildCell = [&] (size_t cell) {
+        const int32_t x = int32_t(cell / size.y), y = int32_t(cell % size.y);
+        if(!isEmpty(grid, x, y)) {
+            return;
+        }
+
+        std::vector<uint8_t> visible(cellCount, 0);
+        std::vector<glm::vec2> dirs(targets.size());
+        std::vector<RayEnd> ends(targets.size());
+        visible[cell] = 1;
+        for(uint32_t point = 0; point < 4 * pointsPerSide; point += 1) {
+            // around the cell, from the corner at (0, 0) of each side
+            const float along = sideInset + (1.0f - 2.0f * sideInset) * float(point % pointsPerSide) / pointsPerSide;
+            const glm::vec2 sides[] = {
+                { along, sideInset },
+                { 1.0f - sideInset, along },
+                { 1.0f - along, 1.0f - sideInset },
+                { sideInset, 1.0f - along },
+            };
+            const glm::vec2 origin(x + sides[point / pointsPerSide].x, y + sides[point / pointsPerSide].y);
+            for(size_t i = 0; i < targets.size(); i += 1) {
+                dirs[i] = glm::vec2(targets[i].x - origin.x, targets[i].y - origin.y);
+                ends[i] = castRay(grid, origin, dirs[i], visible);
+            }
+
+            for(size_t i = 0; i < targets.size(); i += 1) {
+                const size_t next = (i + 1) % targets.size();
+                castWedge(grid, origin, dirs[i], ends[i], dirs[next], ends[next], visible, maxWedgeSplits);
+            }
+        }
+
+        // a sprite is as wide as a cell, so the one in a hidden cell can be seen if it is next to a visible one
+        std::vector<uint8_t> grown(visible);
+        for(int32_t cx = 0; cx < int32_t(size.x); cx += 1) {
+            for(int32_t cy = 0; cy < int32_t(size.y); cy += 1) {
+                if(!visible[size_t(cx) * size.y + cy]) {
+                    continue;
+                }
+
+                for(int32_t nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, int32_t(size.x) - 1); nx += 1) {
+                    for(int32_t ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, int32_t(size.y) - 1); ny += 1) {
+                        grown[size_t(nx) * size.y + ny] = 1;
+                    }
+                }
+            }
+        }
+
+        encode(grown, encoded[cell]);
+    };
+
+    if(pool) {
+        pool->parallelFor(cellCount, buildCell);
+    } else {
+        for(size_t cell = 0; cell < cellCount; cell += 1) {
+            buildCell(cell);
+        }
+    }
+
+    auto result = std::make_shared<PotentiallyVisibleSet>();
+    result->size = size;
+    result->offsets.resize(cellCount + 1);
+    size_t total = 0;
+    for(const auto& runs : encoded) {
+        total += runs.size();
+    }
+
+    result->runs.reserve(total);
+    for(size_t cell = 0; cell < cellCount; cell += 1) {
+        result->offsets[cell] = uint32_t(result->runs.size());
+        result->runs.insert(result->runs.end(), encoded[cell].begin(), encoded[cell].end());
+    }
+    result->offsets[cellCount] = uint32_t(result->runs.size());
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("> Potentially visible set of %ux%u cells built in %.1fms (%zu bytes)\n", size.x, size.y, ms, result->bytes());
+    return result;
+}
+
+bool PotentiallyVisibleSet::visibleFrom(glm::ivec2 cell, std::vector<uint8_t>& visible) const {
+    if(cell.x < 0 || cell.y < 0 || uint32_t(cell.x) >= size.x || uint32_t(cell.y) >= size.y) {
+        return false;
+    }
+
+    const size_t index = size_t(cell.x) * size.y + cell.y;
+    if(offsets[index] == offsets[index + 1]) {
+        return false;
+    }
+
+    visible.resize(size_t(size.x) * size.y);
+    const uint8_t* input = runs.data() + offsets[index];
+    uint8_t value = 0;
+    for(size_t filled = 0; filled < visible.size(); value ^= 1) {
+        const uint32_t length = readVarint(input);
+        std::fill_n(visible.begin() + filled, length, value);
+        filled += length;
+    }
+    return true;
+}
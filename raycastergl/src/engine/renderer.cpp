@@ -0,0 +1,374 @@
+#include <engine/renderer.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <variant>
+#include <glad/glad.h>
+#include <engine/column-data.hpp>
+#include <engine/sprite.hpp>
+#include <engine/textures.hpp>
+#include <opengl/check-error.hpp>
+
+// the spriteculler fills the indirect commands (dispatch for the spritecaster and draw for the sprite quads)
+// and the list of visible sprites, the count is only known by the GPU
+static const uint32_t spriteCommandsReset[] = {
+    0, 1, 1,      // dispatch: x, y, z
+    6, 0, 0, 0, 0 // draw elements: count, instances, first index, base vertex, base instance
+};
+
+Renderer::Renderer(const Options& options):
+    options(options),
+    raycasterDrawProgram("raycaster-draw"),
+    raycasterComputeProgram("raycaster"),
+    spritecasterComputeProgram("spritecaster"),
+    spritecullerComputeProgram("spriteculler"),
+    depthreducerComputeProgram("depthreducer"),
+    spriteDrawProgram("sprite-draw"),
+    raycastResultBuffer(Buffer::ShaderStorageBuffer, 10000 * sizeof(ColumnData)),
+    // min and max wall distance for ranges of columns, the sprites hidden by the walls are culled with it
+    depthHierarchyBuffer(Buffer::ShaderStorageBuffer, 20032 * 2 * sizeof(float)),
+    // the input has the entities of the map, the other sprite buffers the visible ones (all of them grow with the entities)
+    spritecastResultBuffer(Buffer::ShaderStorageBuffer, maxSprites * sizeof(SpriteData)),
+    spritecastInputBuffer(Buffer::ShaderStorageBuffer, maxSprites * sizeof(Sprite), Buffer::DynamicDraw),
+    spriteCommandsBuffer(Buffer::ShaderStorageBuffer, sizeof(spriteCommandsReset) + maxSprites * sizeof(uint32_t)),
+    // one bit for each cell of the biggest map with a potentially visible set
+    visibleCellsBuffer(Buffer::ShaderStorageBuffer, (PotentiallyVisibleSet::maxCells + 31) / 32 * sizeof(uint32_t), Buffer::DynamicDraw),
+    floorImage(Texture::_2D) {}
+
+bool Renderer::load() {
+    // the packed raycaster results are defined in C++, the shaders that use them include the GLSL version
+    Shader::addGeneratedInclude("column-data.glsl", columnDataGlsl());
+    const Shader::Defines textureDefines = { { "TEX_SIZE", std::to_string(textureSize) } };
+    Shader::Defines raycasterDefines = textureDefines;
+    raycasterDefines["RAY_REFINE_STEP"] = std::to_string(options.rayRefineStep);
+    // with sprite quads the depth test hides the sprites, so the drawer does not loop over them
+    Shader::Defines drawerDefines = textureDefines;
+    if(options.spriteQuads) {
+        drawerDefines["SPRITE_QUADS"] = "1";
+    }
+
+    Shader vertexShader(Shader::Vertex);
+    Shader raycasterDrawerShader(Shader::Fragment);
+    Shader raycasterShader(Shader::Compute);
+    Shader spritecasterShader(Shader::Compute);
+    Shader spritecullerShader(Shader::Compute);
+    Shader depthreducerShader(Shader::Compute);
+    Shader spriteVertexShader(Shader::Vertex);
+    Shader spriteDrawerShader(Shader::Fragment);
+    if(
+        !vertexShader.loadAndCompile("vert.glsl") ||
+        !raycasterDrawerShader.loadAndCompile("raycaster-drawer.glsl", drawerDefines) ||
+        !raycasterShader.loadAndCompile("raycaster.glsl", raycasterDefines) ||
+        !spritecasterShader.loadAndCompile("spritecaster.glsl") ||
+        !spritecullerShader.loadAndCompile("spriteculler.glsl") ||
+        !depthreducerShader.loadAndCompile("depthreducer.glsl") ||
+        !spriteVertexShader.loadAndCompile("sprite-vert.glsl") ||
+        !spriteDrawerShader.loadAndCompile("sprite-drawer.glsl")
+    ) {
+        return false;
+    }
+
+    if(
+        !raycasterDrawProgram.link({ &vertexShader, &raycasterDrawerShader }) ||
+        !raycasterComputeProgram.link({ &raycasterShader }) ||
+        !spritecasterComputeProgram.link({ &spritecasterShader }) ||
+        !spritecullerComputeProgram.link({ &spritecullerShader }) ||
+        !depthreducerComputeProgram.link({ &depthreducerShader }) ||
+        !spriteDrawProgram.link({ &spriteVertexShader, &spriteDrawerShader })
+    ) {
+        return false;
+    }
+
+    for(const auto& mapDefines : Map::allShaderDefines()) {
+        Shader::Defines floorcasterDefines = mapDefines;
+        floorcasterDefines.insert(textureDefines.begin(), textureDefines.end());
+        Shader floorcasterShader(Shader::Compute);
+        auto program = std::make_unique<ShaderProgram>("floorcaster");
+        if(!floorcasterShader.loadAndCompile("floorcaster.glsl", floorcasterDefines) || !program->link({ &floorcasterShader })) {
+            return false;
+        }
+
+        floorcasterPrograms[mapDefines] = std::move(program);
+    }
+
+#ifndef NDEBUG
+    // the structs of the shaders must have the same layout as the C++ structs used to fill and size the buffers
+    if(
+        !raycasterComputeProgram.checkBufferLayout("res[0].distWall", offsetof(ColumnData, distWall), sizeof(ColumnData)) ||
+        !spritecasterComputeProgram.checkBufferLayout("sprites[0].flags", offsetof(Sprite, flags), sizeof(Sprite)) ||
+        !spritecasterComputeProgram.checkBufferLayout("spriteResults[0].drawY", offsetof(SpriteData, drawY), sizeof(SpriteData)) ||
+        !spritecasterComputeProgram.checkBufferLayout("spriteResults[0].texture", offsetof(SpriteData, texture), sizeof(SpriteData))
+    ) {
+        return false;
+    }
+#endif
+
+    std::cout << "> Generating plane" << std::endl;
+    screenPlane.addAttribute(BufferAttribute(
+        {
+             1.0f,  1.0f, 0.0f, // top right
+             1.0f, -1.0f, 0.0f, // bottom right
+            -1.0f, -1.0f, 0.0f, // bottom left
+            -1.0f,  1.0f, 0.0f, // top left
+        },
+        3
+    ));
+    screenPlane.addAttribute(BufferAttribute(
+        {
+            1.0f, 1.0f, // top right
+            1.0f, 0.0f, // bottom right
+            0.0f, 0.0f, // bottom left
+            0.0f, 1.0f, // top left
+        },
+        2
+    ));
+    screenPlane.setIndices(BufferAttribute(
+        {
+            0u, 1u, 3u,  // first Triangle
+            1u, 2u, 3u,  // second Triangle
+        },
+        3
+    ));
+
+    std::cout << "> Allocating raycaster output buffer" << std::endl;
+    raycastResultBuffer.setTag("raycaster");
+    raycastResultBuffer.bind();
+
+    std::cout << "> Allocating wall depth hierarchy buffer" << std::endl;
+    depthHierarchyBuffer.setTag("depthreducer");
+    depthHierarchyBuffer.bind();
+
+    std::cout << "> Allocating spritecaster output buffer" << std::endl;
+    spritecastResultBuffer.setTag("spritecaster");
+    spritecastResultBuffer.bind();
+
+    std::cout << "> Allocating spritecaster input buffer" << std::endl;
+    spritecastInputBuffer.setTag("sprites");
+    spritecastInputBuffer.bind();
+
+    std::cout << "> Allocating spriteculler output buffer" << std::endl;
+    spriteCommandsBuffer.setTag("spriteculler");
+    spriteCommandsBuffer.bind();
+
+    std::cout << "> Allocating spriteculler input buffer" << std::endl;
+    visibleCellsBuffer.setTag("visible cells");
+    visibleCellsBuffer.bind();
+
+    // generates the texture array from the pngs
+    textures.emplace(loadTextures());
+
+    // the frame is rendered into this framebuffer
+    renderTarget.setTag("render target");
+
+    // floor and ceiling are casted into this image, it has the same size as the render target
+    floorImage.setTag("floorcaster");
+    floorImage.bind();
+    floorImage.setMinFilter(Texture::Nearest);
+    floorImage.setMagFilter(Texture::Nearest);
+
+    spritecullerComputeProgram.use();
+    spritecullerComputeProgram.setUniform("drawDistance", options.drawDistance);
+
+    // the drawer writes the walls depth, the sprite quads are tested against it
+    checkGlError(glEnable(GL_DEPTH_TEST));
+    return true;
+}
+
+void Renderer::setRenderSize(uvec2 size) {
+    renderSize = size;
+    renderTarget.resize(ivec2(size));
+    // like the render target, the image only grows (the floorcaster uses the screen size, not the image size)
+    floorImage.bind();
+    floorImage.reserveImage2D(Texture::RGBA8, ivec2(size));
+    raycasterComputeProgram.use();
+    raycasterComputeProgram.setUniform("screenSize", size.x, size.y);
+    raycasterDrawProgram.use();
+    raycasterDrawProgram.setUniform("screenSize", size.x, size.y);
+    spritecasterComputeProgram.use();
+    spritecasterComputeProgram.setUniform("screenSize", size.x, size.y);
+    spritecullerComputeProgram.use();
+    spritecullerComputeProgram.setUniform("screenSize", size.x, size.y);
+    depthreducerComputeProgram.use();
+    depthreducerComputeProgram.setUniform("screenSize", size.x, size.y);
+    for(auto& [defines, program] : floorcasterPrograms) {
+        program->use();
+        program->setUniform("screenSize", size.x, size.y);
+    }
+    spriteDrawProgram.use();
+    spriteDrawProgram.setUniform("screenSize", size.x, size.y);
+}
+
+void Renderer::setMap(Map& map) {
+    // the buffer may have the entities of another map
+    map.entities.markAllChanged();
+    visibleCellsCell = { INT32_MIN, INT32_MIN };
+    floorcasterComputeProgram = floorcasterPrograms.at(map.shaderDefines()).get();
+    floorcasterComputeProgram->use();
+    // the type of these uniforms depends on the variant of the floorcaster (see Map::shaderDefines)
+    std::visit([this] (auto floor) { floorcasterComputeProgram->setUniform("floorTex", floor); }, map.floor);
+    std::visit([this] (auto ceil) { floorcasterComputeProgram->setUniform("ceilTex", ceil); }, map.ceil);
+}
+
+void Renderer::setPassTimestamps(GpuTimestamps* timestamps) {
+    passTimestamps = timestamps;
+}
+
+void Renderer::setVisibleSpritesReadback(BufferReadback* readback) {
+    visibleSpritesReadback = readback;
+}
+
+void Renderer::passFinished() {
+    if(passTimestamps) {
+        passTimestamps->endSection();
+    }
+}
+
+void Renderer::updateVisibleCells(const Map& map, vec2 pos) {
+    const ivec2 cell(int32_t(std::floor(pos.x)), int32_t(std::floor(pos.y)));
+    if(map.visibility == visibleCellsSet && cell == visibleCellsCell) {
+        return;
+    }
+
+    visibleCellsSet = map.visibility;
+    visibleCellsCell = cell;
+    spritecullerComputeProgram.use();
+    // without a set (or from inside a wall) every entity can be seen
+    if(!map.visibility || !map.visibility->visibleFrom(cell, visibleCells)) {
+        spritecullerComputeProgram.setUniform("useVisibleCells", 0u);
+        return;
+    }
+
+    const uvec2 size = map.visibility->getSize();
+    visibleCellBits.assign((size_t(size.x) * size.y + 31) / 32, 0);
+    for(size_t i = 0; i < size_t(size.x) * size.y; i += 1) {
+        visibleCellBits[i / 32] |= uint32_t(visibleCells[i] != 0) << (i % 32);
+    }
+
+    visibleCellsBuffer.setData(visibleCellBits.data(), visibleCellBits.size());
+    spritecullerComputeProgram.setUniform("useVisibleCells", 1u);
+    spritecullerComputeProgram.setUniform("visibleCellsSize", int(size.x), int(size.y));
+}
+
+void Renderer::render(Map& map, const Simulation::Camera& camera) {
+    const vec2 pos = camera.pos;
+    const vec2 dir = camera.dir;
+    const vec2 plane = camera.plane;
+
+    renderTarget.bind();
+    checkGlError(glViewport(0, 0, renderSize.x, renderSize.y));
+
+    // the cells and the entities changed since the last frame are uploaded before the passes read them
+    map.uploadChanges();
+    map.entities.uploadChanges(spritecastInputBuffer);
+    updateVisibleCells(map, pos);
+    if(spriteCount != map.entities.size()) {
+        spriteCount = uint32_t(map.entities.size());
+        spritecullerComputeProgram.use();
+        spritecullerComputeProgram.setUniform("spriteCount", spriteCount);
+    }
+
+    // every checked sprite can be visible, the list and the results have room for all of them (twice when
+    // they grow, so adding entities one by one does not allocate every frame)
+    if(spritecastResultBuffer.capacity() < spriteCount * sizeof(SpriteData)) {
+        const size_t sprites = std::max<size_t>(spriteCount, spritecastResultBuffer.capacity() / sizeof(SpriteData) * 2);
+        spritecastResultBuffer.reserve(sprites * sizeof(SpriteData));
+        spriteCommandsBuffer.reserve(sizeof(spriteCommandsReset) + sprites * sizeof(uint32_t));
+    }
+
+    if(passTimestamps) {
+        passTimestamps->beginFrame();
+    }
+
+    //start computing rays
+    // note: binds the texture into the computer shader
+    map.texture->bindImage(1);
+    // note: binds the shared storage into the computer shader
+    raycastResultBuffer.bindBase(2);
+    raycasterComputeProgram.use();
+    raycasterComputeProgram.setUniform("position", pos);
+    raycasterComputeProgram.setUniform("direction", dir);
+    raycasterComputeProgram.setUniform("plane", plane);
+    raycasterComputeProgram.dispatchCompute((renderSize.x + 63) / 64);
+    checkGlError(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+    passFinished();
+
+    // build the min/max hierarchy of the walls distance (one group does everything)
+    depthreducerComputeProgram.use();
+    depthHierarchyBuffer.bindBase(5);
+    depthreducerComputeProgram.dispatchCompute(1);
+    passFinished();
+
+    // discard the sprites that cannot be seen (walls included, so it waits for the hierarchy)
+    spriteCommandsBuffer.setSubData(0, spriteCommandsReset, sizeof(spriteCommandsReset));
+    spritecullerComputeProgram.use();
+    spritecastInputBuffer.bindBase(1);
+    spriteCommandsBuffer.bindBase(4);
+    visibleCellsBuffer.bindBase(6);
+    spritecullerComputeProgram.setUniform("position", pos);
+    spritecullerComputeProgram.setUniform("direction", dir);
+    spritecullerComputeProgram.setUniform("plane", plane);
+    checkGlError(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+    spritecullerComputeProgram.dispatchCompute((spriteCount + 63) / 64);
+    checkGlError(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT));
+    passFinished();
+
+    // start computing sprites positions and sizes (only the visible ones)
+    spritecasterComputeProgram.use();
+    spritecastResultBuffer.bindBase(2);
+    spritecasterComputeProgram.setUniform("position", pos);
+    spritecasterComputeProgram.setUniform("direction", dir);
+    spritecasterComputeProgram.setUniform("plane", plane);
+    spritecasterComputeProgram.dispatchComputeIndirect(spriteCommandsBuffer);
+    passFinished();
+
+    // start casting the floor and ceiling, each instance fills 32 pixels of a row
+    floorcasterComputeProgram->use();
+    textures->bindImage(1, 0, false, 0);
+    floorImage.bindImage(2, 0, true);
+    floorcasterComputeProgram->setUniform("position", pos);
+    floorcasterComputeProgram->setUniform("direction", dir);
+    floorcasterComputeProgram->setUniform("plane", plane);
+    floorcasterComputeProgram->dispatchCompute((renderSize.x + 32 * 8 - 1) / (32 * 8), (renderSize.y / 2 + 7) / 8);
+    passFinished();
+
+    checkGlError(glClearColor(0, 0, 0, 1));
+    checkGlError(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+    //wait until computer shaders finish
+    checkGlError(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT));
+
+    // draw the raycaster result to the screen using the drawing shader
+    // also draws sprites
+    raycasterDrawProgram.use();
+    // texture arrays are layered
+    textures->bindImage(1, 0, false, 0);
+    floorImage.bindImage(2);
+    raycastResultBuffer.bindBase(2);
+    spritecastResultBuffer.bindBase(3);
+    checkGlError(glDepthFunc(GL_ALWAYS));
+    screenPlane.draw();
+
+    // draw the sprites as quads over the walls, the order does not matter thanks to the depth test
+    if(options.spriteQuads) {
+        spriteDrawProgram.use();
+        checkGlError(glDepthFunc(GL_LESS));
+        screenPlane.drawIndirect(spriteCommandsBuffer, 3 * sizeof(uint32_t));
+    }
+
+    passFinished();
+
+    // the instances of the sprites draw command are the visible sprites
+    if(visibleSpritesReadback) {
+        checkGlError(glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT));
+        visibleSpritesReadback->copyFrom(spriteCommandsBuffer, 4 * sizeof(uint32_t));
+    }
+}
+
+void Renderer::blitToScreen(ivec2 pos, ivec2 size) {
+    renderTarget.blitToScreen(pos, size);
+}
+
+void Renderer::readPixels(void* data) {
+    renderTarget.readPixels(data);
+}
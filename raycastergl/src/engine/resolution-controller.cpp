@@ -0,0 +1,58 @@
+#include <engine/resolution-controller.hpp>
+#include <algorithm>
+#include <cmath>
+
+// frames used to average the frame time before changing the scale again
+static constexpr uint32_t samplesPerUpdate = 10;
+// the frame time must be below this fraction of the target to increase the resolution,
+// so it does not go back and forth around the target
+static constexpr double upscaleThreshold = 0.85;
+// maximum change of the scale in an update
+static constexpr float maxStep = 0.1f;
+
+ResolutionController::ResolutionController(float targetFrameMs, float minScale):
+    targetFrameMs(targetFrameMs),
+    minScale(std::clamp(minScale, 0.05f, 1.0f)) {}
+
+bool ResolutionController::update(double frameMs) {
+    if(!isEnabled()) {
+        return false;
+    }
+
+    averageFrameMs += frameMs;
+    samples += 1;
+    if(samples < samplesPerUpdate) {
+        return false;
+    }
+
+    double frameTime = averageFrameMs / samples;
+    averageFrameMs = 0.0;
+    samples = 0;
+
+    const vec2 oldScale = scale;
+    if(frameTime > targetFrameMs) {
+        // the cost is (more or less) proportional to the scale, so this tries to reach the target in one step
+        float factor = std::max(float(targetFrameMs / frameTime), 1.0f - maxStep);
+        if(scale.x > minScale) {
+            scale.x = std::max(scale.x * factor, minScale);
+        } else {
+            scale.y = std::max(scale.y * factor, minScale);
+        }
+    } else if(frameTime < targetFrameMs * upscaleThreshold) {
+        float factor = std::min(float(targetFrameMs * upscaleThreshold / frameTime), 1.0f + maxStep);
+        if(scale.y < 1.0f) {
+            scale.y = std::min(scale.y * factor, 1.0f);
+        } else {
+            scale.x = std::min(scale.x * factor, 1.0f);
+        }
+    }
+
+    return oldScale != scale;
+}
+
+uvec2 ResolutionController::renderSize(uvec2 screenSize) const {
+    return uvec2(
+        std::max(uint32_t(std::round(screenSize.x * scale.x)), 1u),
+        std::max(uint32_t(std::round(screenSize.y * scale.y)), 1u)
+    );
+}
@@ -0,0 +1,258 @@
+#include <engine/simulation.hpp>
+#include <algorithm>
+#include <cmath>
+#include <engine/collision.hpp>
+
+// units per second
+static constexpr float moveSpeed = 3.5f;
+// radians per second
+static constexpr float rotationSpeed = 2.5f;
+// units (and radians) per pixel that the mouse moves
+static constexpr float mouseMoveSpeed = 1.75f / 60.0f;
+static constexpr float mouseRotationSpeed = 1.0f / 60.0f;
+// the player is a circle of this radius for the collisions
+static constexpr float playerRadius = 0.2f;
+
+Simulation::Simulation(double tickRate, bool threaded):
+    tickDuration(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / tickRate))) {
+    if(threaded) {
+        worker = std::thread([this] () { run(); });
+    }
+}
+
+Simulation::~Simulation() {
+    stopping = true;
+    if(worker.joinable()) {
+        worker.join();
+    }
+}
+
+void Simulation::post(std::function<void()> command) {
+    std::lock_guard<std::mutex> lock(commandsMutex);
+    commands.push_back(std::move(command));
+}
+
+void Simulation::resetLevel(const Map& map) {
+    startLevel(map, { map.initialPos, map.initialDir, map.initialPlane });
+}
+
+void Simulation::restoreLevel(const Map& map, const Camera& camera) {
+    startLevel(map, camera);
+}
+
+void Simulation::startLevel(const Map& map, const Camera& start) {
+    // the map can be freed or changed by the render thread, so the simulation has its own copy
+    auto grid = std::make_shared<MapGrid>(map.data, nullptr);
+    struct SolidSprite {
+        uint32_t entity;
+        glm::vec2 pos;
+        float radius;
+    };
+    auto sprites = std::make_shared<std::vector<SolidSprite>>();
+    for(uint32_t i = 0; i < map.entities.size(); i += 1) {
+        if(map.entities.radius(i) > 0.0f) {
+            sprites->push_back({ map.entities.handleAt(i).id, map.entities.position(i), map.entities.radius(i) });
+        }
+    }
+
+    levelStart = start;
+    levelNumber += 1;
+    post([this, grid, sprites, start, number = levelNumber] () {
+        collisionGrid = std::move(*grid);
+        solidSprites.clear();
+        solidIds.clear();
+        for(const auto& sprite : *sprites) {
+            if(sprite.entity >= solidIds.size()) {
+                solidIds.resize(sprite.entity + 1, SpatialHash::none);
+            }
+            solidIds[sprite.entity] = solidSprites.insert(sprite.pos, sprite.radius);
+        }
+        camera = start;
+        simulatedLevel = number;
+    });
+}
+
+void Simulation::setCell(size_t x, size_t y, uint8_t value) {
+    post([this, x, y, value] () {
+        collisionGrid.at(x, y) = value;
+    });
+}
+
+void Simulation::setEntity(EntityHandle handle, glm::vec2 pos, float radius) {
+    post([this, id = handle.id, pos, radius] () {
+        if(id >= solidIds.size()) {
+            solidIds.resize(id + 1, SpatialHash::none);
+        }
+
+        // the hash keeps the radius of an entity, so another radius needs another entity
+        uint32_t& solid = solidIds[id];
+        if(solid != SpatialHash::none && solidSprites.radius(solid) != radius) {
+            solidSprites.remove(solid);
+            solid = SpatialHash::none;
+        }
+
+        if(radius <= 0.0f) {
+            return;
+        }
+
+        if(solid == SpatialHash::none) {
+            solid = solidSprites.insert(pos, radius);
+        } else {
+            solidSprites.move(solid, pos);
+        }
+    });
+}
+
+void Simulation::removeEntity(EntityHandle handle) {
+    post([this, id = handle.id] () {
+        if(id < solidIds.size() && solidIds[id] != SpatialHash::none) {
+            solidSprites.remove(solidIds[id]);
+            solidIds[id] = SpatialHash::none;
+        }
+    });
+}
+
+void Simulation::setCamera(const Camera& value) {
+    post([this, value] () {
+        camera = value;
+    });
+}
+
+void Simulation::advance(uint32_t ticks) {
+    for(uint32_t i = 0; i < ticks; i++) {
+        tick(Clock::now());
+    }
+}
+
+Simulation::Camera Simulation::latestCamera() {
+    snapshots.update();
+    const Snapshot& snapshot = snapshots.read();
+    return snapshot.level == levelNumber ? snapshot.current : levelStart;
+}
+
+void Simulation::setInput(const Input& value) {
+    input.writeSlot() = value;
+    input.publish();
+}
+
+Simulation::Camera Simulation::cameraAt(Clock::time_point time) {
+    snapshots.update();
+    const Snapshot& snapshot = snapshots.read();
+    // until the simulation has started the new level, the player stays at the start
+    if(snapshot.level != levelNumber) {
+        return levelStart;
+    }
+
+    // the camera is one tick behind, so there are always two ticks to interpolate
+    float alpha = std::chrono::duration<float>(time - snapshot.tickTime) / std::chrono::duration<float>(tickDuration);
+    alpha = std::clamp(alpha, 0.0f, 1.0f);
+    const Camera& a = snapshot.previous;
+    const Camera& b = snapshot.current;
+    Camera result = {
+        a.pos + (b.pos - a.pos) * alpha,
+        a.dir + (b.dir - a.dir) * alpha,
+        a.plane + (b.plane - a.plane) * alpha,
+    };
+
+    // dir and plane are rotated, keep their length
+    result.dir *= std::sqrt((b.dir.x * b.dir.x + b.dir.y * b.dir.y) / (result.dir.x * result.dir.x + result.dir.y * result.dir.y));
+    result.plane *= std::sqrt((b.plane.x * b.plane.x + b.plane.y * b.plane.y) / (result.plane.x * result.plane.x + result.plane.y * result.plane.y));
+    return result;
+}
+
+void Simulation::takeTickTimes(TimeHistogram& into) {
+    std::lock_guard<std::mutex> lock(tickTimesMutex);
+    into.merge(tickTimes);
+    tickTimes.reset();
+}
+
+void Simulation::run() {
+    auto nextTick = Clock::now();
+    while(!stopping) {
+        tick(nextTick);
+        nextTick += tickDuration;
+        std::this_thread::sleep_until(nextTick);
+    }
+}
+
+void Simulation::tick(Clock::time_point tickTime) {
+    const float delta = std::chrono::duration<float>(tickDuration).count();
+    const auto tickStart = Clock::now();
+    std::vector<std::function<void()>> pendingCommands;
+    {
+        std::lock_guard<std::mutex> lock(commandsMutex);
+        pendingCommands.swap(commands);
+    }
+
+    for(auto& command : pendingCommands) {
+        command();
+    }
+
+    // the ticks are interpolated from the camera before the step to the camera after it
+    Camera previous = camera;
+    input.update();
+    step(delta, input.read());
+
+    Snapshot& snapshot = snapshots.writeSlot();
+    snapshot.previous = previous;
+    snapshot.current = camera;
+    snapshot.tickTime = tickTime;
+    snapshot.tick = tickNumber;
+    snapshot.level = simulatedLevel;
+    snapshots.publish();
+
+    {
+        std::lock_guard<std::mutex> lock(tickTimesMutex);
+        tickTimes.record(std::chrono::duration<double, std::milli>(Clock::now() - tickStart).count());
+    }
+
+    tickNumber += 1;
+}
+
+void Simulation::step(float delta, const Input& input) {
+    const glm::dvec2 mouseDelta = input.mouseTotal - lastMouseTotal;
+    lastMouseTotal = input.mouseTotal;
+
+    float movement = 0.0f;
+    float rotation = 0.0f;
+    if(input.forward) {
+        movement += moveSpeed * delta;
+    }
+    if(input.backward) {
+        movement -= moveSpeed * delta;
+    }
+    // move forward or backward (with the mouse)
+    if(!(input.forward || input.backward) && std::abs(mouseDelta.y) > 0.001) {
+        movement = -float(mouseDelta.y) * mouseMoveSpeed;
+    }
+    if(std::abs(movement) > 0.00000001f && collisionGrid.size().x > 0) {
+        // the player slides along the walls, and the sprites push it out (and then the walls again)
+        glm::vec2 pos = moveCircle(collisionGrid, camera.pos, camera.dir * movement, playerRadius);
+        if(solidSprites.size() > 0) {
+            pos = separateCircle(solidSprites, pos, playerRadius, nearbySprites);
+            pos = moveCircle(collisionGrid, pos, glm::vec2(0.0f), playerRadius);
+        }
+        camera.pos = pos;
+    }
+
+    if(input.rotateRight) {
+        rotation -= rotationSpeed * delta;
+    }
+    if(input.rotateLeft) {
+        rotation += rotationSpeed * delta;
+    }
+    // rotate camera to the right or left (with the mouse)
+    if(!(input.rotateRight || input.rotateLeft) && std::abs(mouseDelta.x) > 0.001) {
+        rotation = -float(mouseDelta.x) * mouseRotationSpeed;
+    }
+    if(std::abs(rotation) > 0.00000001f) {
+        glm::vec2& dir = camera.dir;
+        glm::vec2& plane = camera.plane;
+        double oldDirX = dir.x;
+        dir.x = dir.x * std::cos(rotation) - dir.y * std::sin(rotation);
+        dir.y = oldDirX * std::sin(rotation) + dir.y * std::cos(rotation);
+        double oldPlaneX = plane.x;
+        plane.x = plane.x * std::cos(rotation) - plane.y * std::sin(rotation);
+        plane.y = oldPlaneX * std::sin(rotation) + plane.y * std::cos(rotation);
+    }
+}
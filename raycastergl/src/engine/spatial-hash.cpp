@@ -0,0 +1,195 @@
+#include <engine/spatial-hash.hpp>
+#include <algorithm>
+
+static size_t nextPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while(result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+SpatialHash::SpatialHash(float cellSize, size_t expectedEntities):
+    cellSize(cellSize),
+    inverseCellSize(1.0f / cellSize) {
+    rehash(nextPowerOfTwo(std::max<size_t>(expectedEntities, 16)));
+}
+
+void SpatialHash::link(uint32_t id) {
+    uint32_t& head = buckets[bucketOf(cells[id])];
+    previous[id] = none;
+    next[id] = head;
+    if(head != none) {
+        previous[head] = id;
+    }
+    head = id;
+}
+
+void SpatialHash::unlink(uint32_t id) {
+    if(previous[id] != none) {
+        next[previous[id]] = next[id];
+    } else {
+        buckets[bucketOf(cells[id])] = next[id];
+    }
+
+    if(next[id] != none) {
+        previous[next[id]] = previous[id];
+    }
+}
+
+void SpatialHash::rehash(size_t bucketCount) {
+    buckets.assign(bucketCount, none);
+    bucketMask = uint32_t(bucketCount - 1);
+    for(uint32_t id = 0; id < positions.size(); id += 1) {
+        // the removed entities have a negative radius
+        if(radii[id] >= 0.0f) {
+            link(id);
+        }
+    }
+}
+
+uint32_t SpatialHash::insert(glm::vec2 pos, float radius) {
+    uint32_t id;
+    if(!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        id = uint32_t(positions.size());
+        positions.emplace_back();
+        radii.emplace_back();
+        cells.emplace_back();
+        next.emplace_back();
+        previous.emplace_back();
+    }
+
+    positions[id] = pos;
+    radii[id] = radius;
+    cells[id] = cellOf(pos);
+    maxRadius = std::max(maxRadius, radius);
+    count += 1;
+
+    // keeps around one entity per bucket
+    if(count > buckets.size()) {
+        rehash(buckets.size() * 2);
+    } else {
+        link(id);
+    }
+    return id;
+}
+
+void SpatialHash::move(uint32_t id, glm::vec2 pos) {
+    positions[id] = pos;
+    const glm::ivec2 cell = cellOf(pos);
+    if(cell == cells[id]) {
+        return;
+    }
+
+    unlink(id);
+    cells[id] = cell;
+    link(id);
+}
+
+void SpatialHash::remove(uint32_t id) {
+    unlink(id);
+    radii[id] = -1.0f;
+    freeIds.push_back(id);
+    count -= 1;
+}
+
+void SpatialHash::clear() {
+    std::fill(buckets.begin(), buckets.end(), none);
+    positions.clear();
+    radii.clear();
+    cells.clear();
+    next.clear();
+    previous.clear();
+    freeIds.clear();
+    count = 0;
+    maxRadius = 0.0f;
+}
+
+void SpatialHash::queryRadius(glm::vec2 center, float radius, std::vector<uint32_t>& result) const {
+    result.clear();
+    const auto touches = [&] (uint32_t id) {
+        const glm::vec2 distance = positions[id] - center;
+        const float reach = radius + radii[id];
+        return distance.x * distance.x + distance.y * distance.y <= reach * reach;
+    };
+
+    const float reach = radius + maxRadius;
+    const glm::ivec2 from = cellOf(center - reach);
+    const glm::ivec2 to = cellOf(center + reach);
+    // a query bigger than the table visits each bucket many times, checking every entity is faster
+    if(size_t(to.x - from.x + 1) * size_t(to.y - from.y + 1) > buckets.size()) {
+        for(uint32_t id = 0; id < positions.size(); id += 1) {
+            if(radii[id] >= 0.0f && touches(id)) {
+                result.push_back(id);
+            }
+        }
+        return;
+    }
+
+    for(int32_t x = from.x; x <= to.x; x += 1) {
+        for(int32_t y = from.y; y <= to.y; y += 1) {
+            const glm::ivec2 cell(x, y);
+            for(uint32_t id = buckets[bucketOf(cell)]; id != none; id = next[id]) {
+                // other cells of the same bucket are skipped, they are visited with their own cell (or not at all)
+                if(cells[id] == cell && touches(id)) {
+                    result.push_back(id);
+                }
+            }
+        }
+    }
+}
+
+uint32_t SpatialHash::nearest(glm::vec2 center, float maxDistance, uint32_t ignore) const {
+    uint32_t best = none;
+    float bestDistance = maxDistance * maxDistance;
+    const auto check = [&] (uint32_t id) {
+        const glm::vec2 distance = positions[id] - center;
+        const float squared = distance.x * distance.x + distance.y * distance.y;
+        if(id != ignore && squared < bestDistance) {
+            best = id;
+            bestDistance = squared;
+        }
+    };
+
+    const int32_t rings = int32_t(std::ceil(maxDistance * inverseCellSize));
+    if(size_t(2 * rings + 1) * size_t(2 * rings + 1) > buckets.size()) {
+        for(uint32_t id = 0; id < positions.size(); id += 1) {
+            if(radii[id] >= 0.0f) {
+                check(id);
+            }
+        }
+        return best;
+    }
+
+    const glm::ivec2 origin = cellOf(center);
+    const auto visit = [&] (int32_t x, int32_t y) {
+        const glm::ivec2 cell(origin.x + x, origin.y + y);
+        for(uint32_t id = buckets[bucketOf(cell)]; id != none; id = next[id]) {
+            if(cells[id] == cell) {
+                check(id);
+            }
+        }
+    };
+
+    // the cells around the center in growing squares, until the next square is farther than the best one
+    visit(0, 0);
+    for(int32_t ring = 1; ring <= rings; ring += 1) {
+        const float ringDistance = float(ring - 1) * cellSize;
+        if(best != none && bestDistance <= ringDistance * ringDistance) {
+            break;
+        }
+
+        for(int32_t i = -ring; i <= ring; i += 1) {
+            visit(i, -ring);
+            visit(i, ring);
+        }
+        for(int32_t i = -ring + 1; i < ring; i += 1) {
+            visit(-ring, i);
+            visit(ring, i);
+        }
+    }
+    return best;
+}
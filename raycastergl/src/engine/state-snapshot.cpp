@@ -0,0 +1,290 @@
+#include <engine/state-snapshot.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+static constexpr char blobMagic[4] = { 'R', 'C', 'S', 'S' };
+static constexpr uint32_t blobVersion = 2;
+static constexpr size_t tileBytes = MapGrid::tileSize * MapGrid::tileSize;
+
+// the values are written in the byte order of the machine (the blobs are not shared between architectures)
+template<typename T>
+static void write(std::vector<uint8_t>& output, const T& value) {
+    const uint8_t* bytes = (const uint8_t*) &value;
+    output.insert(output.end(), bytes, bytes + sizeof(T));
+}
+
+// variable length integers, 7 bits per byte
+static void writeLength(std::vector<uint8_t>& output, size_t value) {
+    while(value >= 0x80) {
+        output.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    output.push_back(uint8_t(value));
+}
+
+struct BlobReader {
+    const uint8_t* data;
+    size_t size;
+    size_t offset = 0;
+
+    template<typename T>
+    bool read(T& value) {
+        if(size - offset < sizeof(T)) {
+            return false;
+        }
+
+        memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool readLength(size_t& value) {
+        value = 0;
+        for(uint32_t shift = 0; shift < 64; shift += 7) {
+            if(offset == size) {
+                return false;
+            }
+
+            const uint8_t byte = data[offset++];
+            value |= size_t(byte & 0x7F) << shift;
+            if((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+static inline size_t pageBytes(size_t storageBytes, size_t page) {
+    return std::min(StateSnapshot::pageSize, storageBytes - page * StateSnapshot::pageSize);
+}
+
+StateSnapshot StateSnapshot::take(const Map& map, const Simulation::Camera& camera, const StateSnapshot* previous) {
+    StateSnapshot snapshot;
+    snapshot.mapSize = map.size;
+    snapshot.camera = camera;
+    snapshot.entities = map.entities;
+
+    const bool sharePages = previous && previous->mapSize == map.size;
+    const size_t storageBytes = map.data.storageBytes();
+    const size_t pageCount = (storageBytes + pageSize - 1) / pageSize;
+    snapshot.pages.reserve(pageCount);
+    for(size_t i = 0; i < pageCount; i += 1) {
+        const uint8_t* cells = map.data.storage() + i * pageSize;
+        const size_t bytes = pageBytes(storageBytes, i);
+        if(sharePages && memcmp(previous->pages[i]->data(), cells, bytes) == 0) {
+            snapshot.pages.push_back(previous->pages[i]);
+            continue;
+        }
+
+        auto page = std::make_shared<Page>();
+        memcpy(page->data(), cells, bytes);
+        std::fill(page->begin() + bytes, page->end(), 0);
+        snapshot.pages.push_back(std::move(page));
+    }
+
+    return snapshot;
+}
+
+bool StateSnapshot::restore(Map& map) const {
+    if(map.size != mapSize) {
+        std::cerr << "  The snapshot is of a " << mapSize.x << "x" << mapSize.y << " map, the map is "
+            << map.size.x << "x" << map.size.y << std::endl;
+        return false;
+    }
+
+    // whole pages are compared first, most of them are the same
+    const size_t storageBytes = map.data.storageBytes();
+    for(size_t i = 0; i < pages.size(); i += 1) {
+        uint8_t* cells = map.data.storage() + i * pageSize;
+        const uint8_t* saved = pages[i]->data();
+        const size_t bytes = pageBytes(storageBytes, i);
+        if(memcmp(cells, saved, bytes) == 0) {
+            continue;
+        }
+
+        // the tiles are copied and uploaded only if they changed, the neighbouring tiles are joined by markChanged
+        for(size_t offset = 0; offset < bytes; offset += tileBytes) {
+            if(memcmp(cells + offset, saved + offset, tileBytes) == 0) {
+                continue;
+            }
+
+            memcpy(cells + offset, saved + offset, tileBytes);
+            const uvec2 tile = map.data.tilePosition((i * pageSize + offset) / tileBytes);
+            const uvec2 start = tile * MapGrid::tileSize;
+            const uvec2 end = glm::min(start + MapGrid::tileSize, map.size);
+            map.markChanged({ start, end });
+        }
+    }
+
+    map.entities.assign(entities);
+    return true;
+}
+
+std::vector<uint8_t> StateSnapshot::serialize() const {
+    std::vector<uint8_t> output;
+    output.insert(output.end(), blobMagic, blobMagic + sizeof(blobMagic));
+    write(output, blobVersion);
+    write(output, mapSize.x);
+    write(output, mapSize.y);
+    write(output, camera);
+    // the packed entities, and the ids so the handles of the game are still valid after deserializing
+    write(output, uint32_t(entities.size()));
+    for(uint32_t i = 0; i < entities.size(); i += 1) {
+        write(output, entities.sprite(i));
+        write(output, entities.radii[i]);
+        write(output, entities.ids[i]);
+    }
+    write(output, uint32_t(entities.slots.size()));
+    for(const auto& slot : entities.slots) {
+        write(output, slot);
+    }
+    write(output, uint32_t(entities.freeIds.size()));
+    for(uint32_t id : entities.freeIds) {
+        write(output, id);
+    }
+
+    // runs of the same cell value through the pages (the padding of the last page is not written)
+    const size_t storageBytes = MapGrid::storageSize(mapSize);
+    size_t runLength = 0;
+    uint8_t runValue = 0;
+    for(size_t i = 0; i < storageBytes; i += 1) {
+        const uint8_t value = (*pages[i / pageSize])[i % pageSize];
+        if(runLength > 0 && value != runValue) {
+            writeLength(output, runLength);
+            output.push_back(runValue);
+            runLength = 0;
+        }
+
+        runValue = value;
+        runLength += 1;
+    }
+
+    if(runLength > 0) {
+        writeLength(output, runLength);
+        output.push_back(runValue);
+    }
+
+    return output;
+}
+
+std::optional<StateSnapshot> StateSnapshot::deserialize(const uint8_t* data, size_t size) {
+    BlobReader reader { data, size };
+    char magic[sizeof(blobMagic)];
+    uint32_t version;
+    if(!reader.read(magic) || memcmp(magic, blobMagic, sizeof(blobMagic)) != 0 || !reader.read(version)) {
+        std::cerr << "  The data is not a snapshot" << std::endl;
+        return std::nullopt;
+    }
+
+    if(version != blobVersion) {
+        std::cerr << "  The snapshot has version " << version << ", only version " << blobVersion << " can be read" << std::endl;
+        return std::nullopt;
+    }
+
+    StateSnapshot snapshot;
+    if(!reader.read(snapshot.mapSize.x) || !reader.read(snapshot.mapSize.y) || !reader.read(snapshot.camera)) {
+        std::cerr << "  The snapshot is truncated" << std::endl;
+        return std::nullopt;
+    }
+
+    const uvec2 mapSize = snapshot.mapSize;
+    if(mapSize.x == 0 || mapSize.y == 0 || mapSize.x > MapGrid::maxSide || mapSize.y > MapGrid::maxSide) {
+        std::cerr << "  The snapshot has an invalid map size (" << mapSize.x << "x" << mapSize.y << ")" << std::endl;
+        return std::nullopt;
+    }
+
+    // each entity takes at least 36 bytes, so a wrong count fails before allocating
+    EntityStore& entities = snapshot.entities;
+    uint32_t entityCount, slotCount, freeCount;
+    if(!reader.read(entityCount) || entityCount > (size - reader.offset) / 36) {
+        std::cerr << "  The entities of the snapshot are invalid" << std::endl;
+        return std::nullopt;
+    }
+
+    for(uint32_t i = 0; i < entityCount; i += 1) {
+        Sprite sprite;
+        float radius;
+        uint32_t id;
+        if(!reader.read(sprite) || !reader.read(radius) || !reader.read(id)) {
+            std::cerr << "  The snapshot is truncated" << std::endl;
+            return std::nullopt;
+        }
+
+        entities.create(sprite, radius);
+        entities.ids[i] = id;
+    }
+
+    if(!reader.read(slotCount) || slotCount > (size - reader.offset) / sizeof(EntityStore::Slot)) {
+        std::cerr << "  The entities of the snapshot are invalid" << std::endl;
+        return std::nullopt;
+    }
+
+    entities.slots.resize(slotCount);
+    for(auto& slot : entities.slots) {
+        reader.read(slot);
+    }
+
+    if(!reader.read(freeCount) || freeCount > (size - reader.offset) / sizeof(uint32_t)) {
+        std::cerr << "  The entities of the snapshot are invalid" << std::endl;
+        return std::nullopt;
+    }
+
+    entities.freeIds.resize(freeCount);
+    for(auto& id : entities.freeIds) {
+        reader.read(id);
+    }
+
+    // every id points to its entity, the free ids to none, and each entity has only one slot
+    const auto validId = [&] (uint32_t id, uint32_t index) {
+        return id < entities.slots.size() && entities.slots[id].index == index;
+    };
+    bool validIds = std::all_of(entities.freeIds.begin(), entities.freeIds.end(), [&] (uint32_t id) { return validId(id, UINT32_MAX); });
+    for(uint32_t i = 0; i < entityCount && validIds; i += 1) {
+        validIds = validId(entities.ids[i], i);
+    }
+    for(uint32_t id = 0; id < slotCount && validIds; id += 1) {
+        const uint32_t index = entities.slots[id].index;
+        validIds = index == UINT32_MAX || (index < entityCount && entities.ids[index] == id);
+    }
+    if(!validIds) {
+        std::cerr << "  The entities of the snapshot are invalid" << std::endl;
+        return std::nullopt;
+    }
+
+    const size_t storageBytes = MapGrid::storageSize(snapshot.mapSize);
+    const size_t pageCount = (storageBytes + pageSize - 1) / pageSize;
+    snapshot.pages.reserve(pageCount);
+    std::shared_ptr<Page> page;
+    size_t cell = 0;
+    while(cell < storageBytes) {
+        size_t runLength;
+        uint8_t value;
+        if(!reader.readLength(runLength) || !reader.read(value) || runLength == 0 || runLength > storageBytes - cell) {
+            std::cerr << "  The cells of the snapshot are invalid" << std::endl;
+            return std::nullopt;
+        }
+
+        // a run can cover several pages
+        while(runLength > 0) {
+            if(cell % pageSize == 0) {
+                page = std::make_shared<Page>();
+                page->fill(0);
+                snapshot.pages.push_back(page);
+            }
+
+            const size_t count = std::min(runLength, pageSize - cell % pageSize);
+            memset(page->data() + cell % pageSize, value, count);
+            cell += count;
+            runLength -= count;
+        }
+    }
+
+    if(reader.offset != size) {
+        std::cerr << "  The snapshot has " << (size - reader.offset) << " bytes after the end" << std::endl;
+        return std::nullopt;
+    }
+
+    return snapshot;
+}
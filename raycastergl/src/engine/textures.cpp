@@ -0,0 +1,79 @@
+#include <engine/textures.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <stb_image.h>
+#include <utils/files.hpp>
+
+Texture loadTextures() {
+    typedef struct {
+        stbi_uc* data;
+        int width;
+        int height;
+        int components;
+        const char* path;
+    } stbiLoadStruct;
+
+    const auto stbiLoad = [] (const char* path, const int c) -> stbiLoadStruct {
+        std::cout << "> Reading texture " << path << std::endl;
+        stbiLoadStruct res;
+        res.path = path;
+        res.data = loadImage(path, res.width, res.height, c, &res.components);
+        return res;
+    };
+
+    stbiLoadStruct textures[] = {
+        stbiLoad("textures/eagle.png", 3),
+        stbiLoad("textures/redbrick.png", 3),
+        stbiLoad("textures/purplestone.png", 3),
+        stbiLoad("textures/greystone.png", 3),
+        stbiLoad("textures/bluestone.png", 3),
+        stbiLoad("textures/mossy.png", 3),
+        stbiLoad("textures/wood.png", 3),
+        stbiLoad("textures/colorstone.png", 3),
+
+        stbiLoad("textures/barrel.png", 3),
+        stbiLoad("textures/pillar.png", 3),
+        stbiLoad("textures/greenlight.png", 3),
+    };
+
+    Texture glTextures(Texture::Array2D);
+    glTextures.setTag("wall textures");
+    glTextures.bind();
+    glTextures.setWrap(Texture::Repeat, Texture::Repeat);
+    glTextures.setMinFilter(Texture::Nearest);
+    glTextures.setMagFilter(Texture::Nearest);
+    glTextures.reserveStorage3D(Texture::RGBA32F, { textureSize, textureSize, 11 });
+
+    for(size_t i = 0; i < 11; i += 1) {
+        const auto& texture = textures[i];
+        std::cout << "> Loading texture " << texture.path << std::endl;
+        glTextures.fillSubImage3D(
+            0,
+            { 0, 0, i },
+            { texture.width, texture.height, 1 },
+            Texture::RGB,
+            Texture::UnsignedByte,
+            texture.data
+        );
+
+        free(texture.data);
+    }
+
+    return glTextures;
+}
+
+// decodes the image directly from the mapped file (stbi_load reads it through a FILE* and its own buffer)
+uint8_t* loadImage(const char* path, int& width, int& height, int components, int* fileComponents) {
+    auto file = MappedFile::open(resourcePath(path));
+    if(file == std::nullopt) {
+        std::cerr << "Could not read image " << path << std::endl;
+        return nullptr;
+    }
+
+    auto data = stbi_load_from_memory(file->data(), int(file->size()), &width, &height, fileComponents, components);
+    if(data == nullptr) {
+        std::cerr << "Could not decode image " << path << ": " << stbi_failure_reason() << std::endl;
+    }
+
+    return data;
+}
@@ -6,15 +6,36 @@
 #endif
 #include <cmath>
 #include <iostream>
-#include <stb_image.h>
+#include <memory>
+#include <unordered_map>
 #include <glm/vec2.hpp>
 #include <glm/geometric.hpp>
 #include <arguments.hpp>
-#include <engine/map.hpp>
-#include <opengl/shader-program.hpp>
-#include <opengl/buffer-geometry.hpp>
-#include <opengl/texture.hpp>
+#include <benchmarks/batch-rendering.hpp>
+#include <benchmarks/entity-queries.hpp>
+#include <benchmarks/map-layout.hpp>
+#include <engine/batch-renderer.hpp>
+#include <engine/column-data.hpp>
+#include <engine/frame-pacer.hpp>
+#include <engine/frame-stats.hpp>
+#include <engine/frame-streamer.hpp>
+#include <engine/level-manager.hpp>
+#include <engine/metrics-exporter.hpp>
+#include <engine/renderer.hpp>
+#include <engine/resolution-controller.hpp>
+#include <engine/simulation.hpp>
+#include <engine/state-snapshot.hpp>
+#include <engine/textures.hpp>
+#include <opengl/buffer-readback.hpp>
+#include <opengl/frame-fences.hpp>
+#include <opengl/frame-readback.hpp>
+#include <opengl/framebuffer.hpp>
+#include <opengl/gpu-memory.hpp>
+#include <opengl/gpu-timer.hpp>
+#include <opengl/gpu-timestamps.hpp>
 #include <opengl/check-error.hpp>
+#include <utils/allocation-counter.hpp>
+#include <utils/files.hpp>
 
 #include "utils/defer.hpp"
 
@@ -24,10 +45,9 @@ using namespace glm;
 struct MainContext {
     std::function<void(int, int)> onFramebufferSizeChanged;
     std::function<void(dvec2 pos)> onMousePositionChanged;
+    std::function<void(int key)> onKeyPressed;
 };
 
-static Texture generateTextures();
-
 int main(int argc, const char* const argv[]) {
     MainContext mainCtx;
     Arguments arguments;
@@ -40,6 +60,14 @@ int main(int argc, const char* const argv[]) {
     std::cout << "[!!] DEBUG enabled" << std::endl;
 #endif
 
+    if(arguments.benchmarkMapLayout) {
+        return runMapLayoutBenchmark();
+    }
+
+    if(arguments.benchmarkEntityQueries) {
+        return runEntityQueriesBenchmark();
+    }
+
     std::cout << "> Creating window and OpenGL context" << std::endl;
     glfwInit();
 
@@ -50,6 +78,10 @@ int main(int argc, const char* const argv[]) {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // the batch mode only needs the context
+    if(arguments.batchCameras > 0) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    }
 
     int width = arguments.initialWindowSize.x, height = arguments.initialWindowSize.y;
     auto window = glfwCreateWindow(width, height, "raycastergl", nullptr, nullptr);
@@ -89,6 +121,11 @@ int main(int argc, const char* const argv[]) {
     });
 
     glfwSetKeyCallback(window, [] (auto window, int key, int, int action, int) {
+        MainContext* ctx = (MainContext*) glfwGetWindowUserPointer(window);
+        if(ctx->onKeyPressed && action == GLFW_PRESS) {
+            ctx->onKeyPressed(key);
+        }
+
         if(key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
             glfwSetWindowShouldClose(window, true);
         }
@@ -129,111 +166,64 @@ int main(int argc, const char* const argv[]) {
 
     // window icon :)
     GLFWimage icon;
-    icon.pixels = stbi_load("res/textures/eagle.png", &icon.width, &icon.height, nullptr, 4);
-    glfwSetWindowIcon(window, 1, &icon);
-    free(icon.pixels);
+    icon.pixels = loadImage("textures/eagle.png", icon.width, icon.height, 4);
+    if(icon.pixels) {
+        glfwSetWindowIcon(window, 1, &icon);
+        free(icon.pixels);
+    }
 
     // loading game resources
-    Shader vertexShader(Shader::Vertex);
-    Shader raycasterDrawerShader(Shader::Fragment);
-    Shader raycasterShader(Shader::Compute);
-    Shader spritecasterShader(Shader::Compute);
-    if(
-        !vertexShader.loadAndCompile("vert.glsl") ||
-        !raycasterDrawerShader.loadAndCompile("raycaster-drawer.glsl") ||
-        !raycasterShader.loadAndCompile("raycaster.glsl") ||
-        !spritecasterShader.loadAndCompile("spritecaster.glsl")
-    ) {
-        return -1;
+    // (the next maps are loaded in the background, see LevelManager)
+    LevelManager levels;
+    if(!levels.load(arguments.map)) {
+        return 1;
     }
 
-    ShaderProgram raycasterDrawProgram("raycaster-draw");
-    ShaderProgram raycasterComputeProgram("raycaster");
-    ShaderProgram spritecasterComputeProgram("spritecaster");
-    if(
-        !raycasterDrawProgram.link({ &vertexShader, &raycasterDrawerShader }) ||
-        !raycasterComputeProgram.link({ &raycasterShader }) ||
-        !spritecasterComputeProgram.link({ &spritecasterShader })
-    ) {
-        return -1;
+    // the player moves in its own thread
+    Simulation simulation(arguments.tickRate);
+
+    // many cameras rendered at once (for agents), instead of the game
+    if(arguments.batchCameras > 0) {
+        Shader::addGeneratedInclude("column-data.glsl", columnDataGlsl());
+        const Shader::Defines textureDefines = { { "TEX_SIZE", std::to_string(textureSize) } };
+        auto batchTextures = loadTextures();
+        BatchRenderer batchRenderer(
+            arguments.batchCameras,
+            arguments.batchSize,
+            arguments.useBatchTensor() ? BatchRenderer::Tensor : BatchRenderer::Layers
+        );
+        if(!batchRenderer.load(levels.current(), textureDefines, arguments.rayRefineStep)) {
+            return -1;
+        }
+
+        return runBatchRenderingBenchmark(batchRenderer, levels.current(), batchTextures, arguments.batchFrames);
     }
 
-    std::cout << "> Generating plane" << std::endl;
-    BufferGeometry screenPlane;
-    screenPlane.addAttribute(BufferAttribute(
-        {
-             1.0f,  1.0f, 0.0f, // top right
-             1.0f, -1.0f, 0.0f, // bottom right
-            -1.0f, -1.0f, 0.0f, // bottom left
-            -1.0f,  1.0f, 0.0f, // top left
-        },
-        3
-    ));
-    screenPlane.addAttribute(BufferAttribute(
-        {
-            1.0f, 1.0f, // top right
-            1.0f, 0.0f, // bottom right
-            0.0f, 0.0f, // bottom left
-            0.0f, 1.0f, // top left
-        },
-        2
-    ));
-    screenPlane.setIndices(BufferAttribute(
-        {
-            0u, 1u, 3u,  // first Triangle
-            1u, 2u, 3u,  // second Triangle
-        },
-        3
-    ));
-
-    auto maybeMap = Map::load(arguments.map);
-    if(maybeMap == std::nullopt) {
-        return 1;
+    Renderer renderer({ arguments.rayRefineStep, arguments.useSpriteQuads(), arguments.drawDistance });
+    if(!renderer.load()) {
+        return -1;
     }
 
-    auto& map = maybeMap.value();
-    DEFER(map.destroy());
-
-    std::cout << "> Allocating raycaster output buffer" << std::endl;
-    Buffer raycastResultBuffer(
-        Buffer::ShaderStorageBuffer,
-        10000 * (5 * sizeof(int32_t) + 5 * sizeof(float))
-    );
-    raycastResultBuffer.bind();
-
-    std::cout << "> Allocating spritecaster output buffer" << std::endl;
-    Buffer spritecastResultBuffer(
-        Buffer::ShaderStorageBuffer,
-        map.sprites.size() * (8 * sizeof(int32_t) + 1 * sizeof(float) + 1 * sizeof(uint32_t))
-    );
-    spritecastResultBuffer.bind();
-
-    std::cout << "> Allocating spritecaster input buffer" << std::endl;
-    Buffer spritecastInputBuffer(
-        Buffer::ShaderStorageBuffer,
-        map.sprites.size() * sizeof(Sprite),
-        Buffer::DynamicCopy
-    );
-    spritecastInputBuffer.bind();
-
-    // generates the texture array from the pngs
-    auto glTextures = generateTextures();
+    ResolutionController resolutionController(arguments.targetFrameMs, arguments.minRenderScale);
+    GpuTimer frameTimer;
 
     // another functions and callbacks
+    uvec2 viewportSize, viewportPos;
+    auto renderSizeChanged = [&renderer] (uvec2 size) {
+        renderer.setRenderSize(size);
+    };
+
     auto framebufferSizeChanged = [
-        &raycasterComputeProgram,
-        &raycasterDrawProgram,
-        &spritecasterComputeProgram
+        &renderSizeChanged,
+        &resolutionController,
+        &viewportSize,
+        &viewportPos
     ] (uvec2 size, uvec2 pos) {
         std::cout << "\rFramebuffer set to (" << size.x << ", " << size.y
             << "), position (" << pos.x << ", " << pos.y << ")" << std::endl;
-        glViewport(pos.x, pos.y, size.x, size.y);
-        raycasterComputeProgram.use();
-        raycasterComputeProgram.setUniform("screenSize", size.x, size.y);
-        raycasterDrawProgram.use();
-        raycasterDrawProgram.setUniform("screenSize", size.x, size.y);
-        spritecasterComputeProgram.use();
-        spritecasterComputeProgram.setUniform("screenSize", size.x, size.y);
+        viewportSize = size;
+        viewportPos = pos;
+        renderSizeChanged(resolutionController.renderSize(size));
     };
 
     auto handleWindowSize = [&framebufferSizeChanged] (uvec2 size) {
@@ -261,225 +251,246 @@ int main(int argc, const char* const argv[]) {
     };
 
     // define here our mouse position listener alongside with the player variables, so we can modify them here
-    vec2 mouseDirection(0, 0);
-    mainCtx.onMousePositionChanged = [window, &mouseDirection] (dvec2 pos) {
+    // (the movements are added up, the simulation takes the difference between its ticks)
+    dvec2 mouseTotal(0, 0);
+    mainCtx.onMousePositionChanged = [window, &mouseTotal] (dvec2 pos) {
         static dvec2 oldPos(pos);
 
         if(glfwGetInputMode(window, GLFW_CURSOR) == GLFW_CURSOR_DISABLED) {
             dvec2 diff = pos - oldPos;
-            mouseDirection = diff;
+            mouseTotal += diff;
         }
 
         oldPos = pos;
     };
 
-    // sorted sprites list
-    std::vector<Sprite> sortedSprites(map.sprites);
-    raycasterDrawProgram.use();
-    raycasterDrawProgram.setUniform("spriteCount", sortedSprites.size());
-    if(std::holds_alternative<vec3>(map.floor)) {
-        raycasterDrawProgram.setUniform("floorTex", vec4(std::get<vec3>(map.floor), 0.f));
-    } else {
-        raycasterDrawProgram.setUniform("floorTex", vec4(0.f, 0.f, 0.f, std::get<uint32_t>(map.floor)));
+    vec2 pos, dir, plane;
+    std::unordered_map<size_t, uint8_t> openedWalls;
+    std::optional<StateSnapshot> quickSave;
+    // the walls opened when the quick save was taken, so E can close them again after F9
+    std::unordered_map<size_t, uint8_t> quickSaveWalls;
+    // places the player at the start of the map
+    auto levelChanged = [&renderer, &simulation, &openedWalls, &quickSave, &quickSaveWalls] (Map& map) {
+        renderer.setMap(map);
+        simulation.resetLevel(map);
+        openedWalls.clear();
+        quickSave.reset();
+        quickSaveWalls.clear();
+    };
+
+    levelChanged(levels.current());
+    std::cout << "> Game loaded" << std::endl;
+    if(arguments.memoryReport) {
+        GpuMemory::printReport();
     }
 
-    if(std::holds_alternative<vec3>(map.ceil)) {
-        raycasterDrawProgram.setUniform("ceilTex", vec4(std::get<vec3>(map.ceil), 0.f));
-    } else {
-        raycasterDrawProgram.setUniform("ceilTex", vec4(0.f, 0.f, 0.f, std::get<uint32_t>(map.ceil)));
+    // E opens (removes) the wall in front of the player, or closes it again with the same texture
+    // N loads the next map in the background, and changes to it when it is ready
+    // F5 saves the state of the level (camera, walls and sprites), and F9 goes back to it
+    mainCtx.onKeyPressed = [&levels, &simulation, &pos, &dir, &openedWalls, &quickSave, &quickSaveWalls] (int key) {
+        if(key == GLFW_KEY_N) {
+            levels.preloadNext();
+            return;
+        }
+
+        // the camera of the last tick, not the one drawn (it is interpolated between two ticks)
+        if(key == GLFW_KEY_F5) {
+            quickSave = StateSnapshot::take(levels.current(), simulation.latestCamera(), quickSave ? &*quickSave : nullptr);
+            quickSaveWalls = openedWalls;
+            return;
+        }
+
+        if(key == GLFW_KEY_F9 && quickSave && quickSave->restore(levels.current())) {
+            simulation.restoreLevel(levels.current(), quickSave->getCamera());
+            openedWalls = quickSaveWalls;
+            return;
+        }
+
+        if(key != GLFW_KEY_E) {
+            return;
+        }
+
+        Map& map = levels.current();
+        ivec2 cell = ivec2(pos + dir);
+        // the walls of the border are never opened, they close the map for the rays
+        if(cell.x <= 0 || cell.y <= 0 || uint32_t(cell.x) >= map.size.x - 1 || uint32_t(cell.y) >= map.size.y - 1 || cell == ivec2(pos)) {
+            return;
+        }
+
+        size_t cellIndex = cell.x * map.size.y + cell.y;
+        uint8_t value = map.at(cell.x, cell.y);
+        if(value != 0) {
+            openedWalls[cellIndex] = value;
+            map.set(cell.x, cell.y, 0);
+            simulation.setCell(cell.x, cell.y, 0);
+        } else if(auto opened = openedWalls.find(cellIndex); opened != openedWalls.end()) {
+            map.set(cell.x, cell.y, opened->second);
+            simulation.setCell(cell.x, cell.y, opened->second);
+            openedWalls.erase(opened);
+        }
+    };
+
+    FrameFences frameFences(arguments.maxFramesInFlight);
+    FramePacer framePacer(arguments.maxFps);
+    FrameStats frameStats(arguments.statsInterval, arguments.statsFile);
+
+    // the GPU time of each pass and the visible sprites are only measured for the metrics
+    std::optional<MetricsExporter> metrics;
+    std::optional<GpuTimestamps> passTimestamps;
+    std::optional<BufferReadback> visibleSpritesReadback;
+    std::vector<double> gpuPassesMs(MetricsExporter::GpuPassCount);
+    if(!arguments.metrics.empty()) {
+        metrics.emplace(arguments.metrics);
+        if(!metrics->start()) {
+            return 1;
+        }
+
+        passTimestamps.emplace(MetricsExporter::GpuPassCount);
+        visibleSpritesReadback.emplace(sizeof(uint32_t));
+        renderer.setPassTimestamps(&*passTimestamps);
+        renderer.setVisibleSpritesReadback(&*visibleSpritesReadback);
     }
 
-    std::cout << "> Game loaded" << std::endl;
-    vec2 pos = map.initialPos;
-    vec2 dir = map.initialDir;
-    vec2 plane = map.initialPlane;
-    double previousTime = glfwGetTime() - 1.0 / 60.0;
+    // the frames are read back some frames later, so the stream never makes the render thread wait for the GPU
+    std::optional<FrameStreamer> streamer;
+    std::optional<FrameReadback> streamReadback;
+    if(!arguments.stream.empty()) {
+        streamer.emplace(arguments.stream, arguments.statsInterval);
+        if(!streamer->start()) {
+            return 1;
+        }
+
+        streamReadback.emplace();
+    }
+
+    glfwSwapInterval(arguments.vsync);
+
     double lastFpsTick = glfwGetTime();
     uint32_t fps = 0;
-    bool initialSpriteFill = false;
+    // with --check-allocations, the frames after the warm up (when the caches are filled) must not allocate
+    static constexpr uint32_t allocationWarmupFrames = 120;
+    uint64_t frameNumber = 0;
+    uint32_t allocatingFrames = 0;
     while(!glfwWindowShouldClose(window)) {
-        //start computing rays
-        // note: binds the texture into the computer shader
-        map.texture->bindImage(1);
-        // note: binds the shared storage into the computer shader
-        raycastResultBuffer.bindBase(2);
-        raycasterComputeProgram.use();
-        raycasterComputeProgram.setUniform("position", pos);
-        raycasterComputeProgram.setUniform("direction", dir);
-        raycasterComputeProgram.setUniform("plane", plane);
-        raycasterComputeProgram.dispatchCompute(width);
-
-        // start computing sprites positions and sizes
-        spritecasterComputeProgram.use();
-        spritecastInputBuffer.bindBase(1);
-        spritecastResultBuffer.bindBase(2);
-        spritecasterComputeProgram.setUniform("position", pos);
-        spritecasterComputeProgram.setUniform("direction", dir);
-        spritecasterComputeProgram.setUniform("plane", plane);
-        spritecasterComputeProgram.dispatchCompute(map.sprites.size());
-
-        checkGlError(glClearColor(0, 0, 0, 1));
-        checkGlError(glClear(GL_COLOR_BUFFER_BIT));
+        const uint64_t allocationsAtStart = threadAllocationCount();
 
-        //wait until computer shaders finish
-        checkGlError(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+        // the waits for the GPU and for the frame rate cap are done before reading the input, so they do not add latency
+        frameFences.waitForFrameSlot();
+        framePacer.waitForNextFrame();
+
+        // the input goes to the simulation, which reads the last one in each tick
+        glfwPollEvents();
+        framePacer.inputSampled();
+        const auto cpuStart = FrameStats::Clock::now();
+        simulation.setInput({
+            glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS,
+            glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS,
+            glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS,
+            glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS,
+            mouseTotal,
+        });
+
+        // a preloaded map replaces the current one between two frames
+        if(levels.swapIfReady()) {
+            levelChanged(levels.current());
+        }
+        // the visibility set of the map is built again after opening or closing walls
+        levels.updateVisibility();
 
-        // draw the raycaster result to the screen using the drawing shader
-        // also draws sprites
-        raycasterDrawProgram.use();
-        // texture arrays are layered
-        glTextures.bindImage(1, 0, false, 0);
-        raycastResultBuffer.bindBase(2);
-        spritecastResultBuffer.bindBase(3);
-        raycasterDrawProgram.setUniform("position", pos);
-        screenPlane.draw();
+        Map& map = levels.current();
+
+        frameTimer.begin();
+
+        // the camera of the simulation, interpolated for the time of this frame
+        // (read as late as possible, just before the first command that uses it)
+        auto camera = simulation.cameraAt(Simulation::Clock::now());
+        pos = camera.pos;
+        dir = camera.dir;
+        plane = camera.plane;
+
+        renderer.render(map, camera);
+        frameTimer.end();
+
+        if(streamer) {
+            auto& streamFrame = streamer->nextFrame();
+            if(streamReadback->read(streamFrame.pixels, streamFrame.size)) {
+                streamFrame.number = frameNumber;
+                streamer->frameReady();
+            }
+            streamReadback->copyFrom(renderer.getRenderTarget());
+        }
+
+        // upscale the frame into the visible section of the window (the rest is black)
+        Framebuffer::bindScreen();
+        checkGlError(glClear(GL_COLOR_BUFFER_BIT));
+        renderer.blitToScreen(ivec2(viewportPos), ivec2(viewportSize));
 
         // this code writes the raycaster result 2.0 into a file (not so slow as the texture version)
         // raycastResultBuffer._writeContentsToFile("yes.bin");
 
-        glfwSwapInterval(arguments.vsync);
+        const auto swapStart = FrameStats::Clock::now();
         glfwSwapBuffers(window);
-        glfwPollEvents();
+        frameStats.frameFinished(cpuStart, swapStart, FrameStats::Clock::now(), simulation);
+        if(metrics) {
+            auto& sample = metrics->sample();
+            visibleSpritesReadback->read(&sample.visibleSprites);
+            if(passTimestamps->getSectionsMs(gpuPassesMs)) {
+                metrics->gpuPassesMeasured(gpuPassesMs);
+            }
 
-        const float currentTime = glfwGetTime();
-        const float delta = currentTime - previousTime;
-        const float moveSpeed = delta * 3.5f;
-        const float rotationSpeed = delta * 2.5f;
-        float movement = 0.0f;
-        float rotation = 0.0f;
-        // move forward
-        const bool forwardPressed = glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS
-            || glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS;
-        if(forwardPressed) {
-            movement += moveSpeed;
-        }
-        // move backward
-        const bool backwardPressed = glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS
-            || glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS;
-        if(backwardPressed) {
-            movement -= moveSpeed;
-        }
-        // move forward or backward (with the mouse)
-        if(!(forwardPressed || backwardPressed) && abs(mouseDirection.y) > 0.001f) {
-            movement = -delta * mouseDirection.y * 1.75f;
-        }
-        if(abs(movement) > 0.00000001f) {
-            // move only if the player does not collide with some wall
-            if(map.at(int(pos.x + dir.x * movement), int(pos.y)) == 0)
-                pos.x += dir.x * movement;
-            if(map.at(int(pos.x), int(pos.y + dir.y * movement)) == 0)
-                pos.y += dir.y * movement;
-        }
-        // rotate camera to the right
-        const bool rotateRightPressed = glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS
-            || glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
-        if(rotateRightPressed) {
-            rotation -= rotationSpeed;
-        }
-        // rotate camera to the left
-        const bool rotateLeftPressed = glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS
-            || glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS;
-        if(rotateLeftPressed) {
-            rotation += rotationSpeed;
-        }
-        // rotate camera to the right or left
-        if(!(rotateRightPressed || rotateLeftPressed) && abs(mouseDirection.x) > 0.001f) {
-            rotation = -mouseDirection.x * delta;
-        }
-        if(abs(rotation) > 0.00000001f) {
-            double oldDirX = dir.x;
-            dir.x = dir.x * cos(rotation) - dir.y * sin(rotation);
-            dir.y = oldDirX * sin(rotation) + dir.y * cos(rotation);
-            double oldPlaneX = plane.x;
-            plane.x = plane.x * cos(rotation) - plane.y * sin(rotation);
-            plane.y = oldPlaneX * sin(rotation) + plane.y * cos(rotation);
+            sample.sprites = map.entities.size();
+            sample.textureBytes = GpuMemory::totalBytes(GpuMemory::Textures) + GpuMemory::totalBytes(GpuMemory::Renderbuffers);
+            sample.bufferBytes = GpuMemory::totalBytes(GpuMemory::Buffers);
+            sample.mapLoadMs = levels.currentMapLoadMs();
+            sample.mapLoads = levels.loadedMapsCount();
+            metrics->frameFinished(frameStats.lastFrameMs());
         }
+        frameFences.frameSubmitted();
+        framePacer.frameSwapped();
 
-        // update sprites order depending on player's position
-        if(currentTime - lastFpsTick >= 1 || !initialSpriteFill) {
-            initialSpriteFill = true;
-            // sort sprites
-            std::sort(sortedSprites.begin(), sortedSprites.end(), [pos] (auto& a, auto& b) {
-                const float distA = distance(pos, (vec2) a);
-                const float distB = distance(pos, (vec2) b);
-                return distA > distB;
-            });
-
-            spritecastInputBuffer.bind();
-            spritecastInputBuffer.setData(sortedSprites.data(), sortedSprites.size());
+        // the resolution is changed using the GPU time of the frame (when the controller is enabled)
+        if(auto frameMs = frameTimer.getElapsedMs(); frameMs && resolutionController.update(*frameMs)) {
+            renderSizeChanged(resolutionController.renderSize(viewportSize));
         }
 
-        previousTime = currentTime;
-        mouseDirection = { 0, 0 };
-
+        const float currentTime = glfwGetTime();
         if(currentTime - lastFpsTick >= 1) {
             lastFpsTick = currentTime;
-            printf("\r                                     ");
-            printf("\rfps: %i (%.2f, %.2f)", fps, pos.x, pos.y);
+            const uvec2 renderSize = renderer.getRenderSize();
+            auto latency = framePacer.takeLatencyStats();
+            printf("\r                                                                ");
+            printf("\rfps: %i (%.2f, %.2f) [%ux%u] poll-to-swap: %.1fms (max %.1fms)", fps, pos.x, pos.y, renderSize.x, renderSize.y, latency.averageMs, latency.maxMs);
             fflush(stdout);
             fps = 0;
         } else {
             fps += 1;
         }
-    }
 
-    printf("\n");
-    return 0;
-}
-
-static Texture generateTextures() {
-    typedef struct {
-        stbi_uc* data;
-        int width;
-        int height;
-        int components;
-        const char* path;
-    } stbiLoadStruct;
-
-    const auto stbiLoad = [] (const char* path, const int c) -> stbiLoadStruct {
-        std::cout << "> Reading texture " << path << std::endl;
-        stbiLoadStruct res;
-        res.path = path;
-        res.data = stbi_load(path, &res.width, &res.height, &res.components, c);
-        return res;
-    };
+        frameNumber += 1;
+        if(arguments.checkAllocations > 0 && frameNumber > allocationWarmupFrames) {
+            if(uint64_t allocations = threadAllocationCount() - allocationsAtStart; allocations > 0) {
+                std::cerr << "\r  Frame " << frameNumber << " allocated memory " << allocations << " times" << std::endl;
+                allocatingFrames += 1;
+            }
 
-    stbiLoadStruct textures[] = {
-        stbiLoad("res/textures/eagle.png", 3),
-        stbiLoad("res/textures/redbrick.png", 3),
-        stbiLoad("res/textures/purplestone.png", 3),
-        stbiLoad("res/textures/greystone.png", 3),
-        stbiLoad("res/textures/bluestone.png", 3),
-        stbiLoad("res/textures/mossy.png", 3),
-        stbiLoad("res/textures/wood.png", 3),
-        stbiLoad("res/textures/colorstone.png", 3),
-
-        stbiLoad("res/textures/barrel.png", 3),
-        stbiLoad("res/textures/pillar.png", 3),
-        stbiLoad("res/textures/greenlight.png", 3),
-    };
+            if(frameNumber == allocationWarmupFrames + arguments.checkAllocations) {
+                glfwSetWindowShouldClose(window, true);
+            }
+        }
+    }
 
-    Texture glTextures(Texture::Array2D);
-    glTextures.bind();
-    glTextures.setWrap(Texture::Repeat, Texture::Repeat);
-    glTextures.setMinFilter(Texture::Nearest);
-    glTextures.setMagFilter(Texture::Nearest);
-    glTextures.reserveStorage3D(Texture::RGBA32F, { 64, 64, 11 });
-
-    for(size_t i = 0; i < 11; i += 1) {
-        const auto& texture = textures[i];
-        std::cout << "> Loading texture " << texture.path << std::endl;
-        glTextures.fillSubImage3D(
-            0,
-            { 0, 0, i },
-            { texture.width, texture.height, 1 },
-            Texture::RGB,
-            Texture::UnsignedByte,
-            texture.data
-        );
+    printf("\n");
+    frameStats.finish(simulation);
+    if(arguments.memoryReport) {
+        GpuMemory::printReport();
+    }
 
-        free(texture.data);
+    if(arguments.checkAllocations > 0) {
+        std::cout << "> " << allocatingFrames << " of " << arguments.checkAllocations << " frames allocated memory" << std::endl;
+        if(allocatingFrames > 0) {
+            return 1;
+        }
     }
 
-    return glTextures;
+    return 0;
 }
@@ -18,12 +18,12 @@ BufferGeometry::~BufferGeometry() {
     }
 }
 
-void BufferGeometry::setIndices(const BufferAttribute& indices) {
-    this->indices = indices;
+void BufferGeometry::setIndices(BufferAttribute&& indices) {
+    this->indices.emplace(std::move(indices));
 }
 
-void BufferGeometry::addAttribute(const BufferAttribute& attribute) {
-    attributes.push_back(attribute);
+void BufferGeometry::addAttribute(BufferAttribute&& attribute) {
+    attributes.push_back(std::move(attribute));
 }
 
 void BufferGeometry::build() {
@@ -44,12 +44,16 @@ void BufferGeometry::build() {
     }
 }
 
-void BufferGeometry::draw() {
+void BufferGeometry::bindVertexArray() {
     if(!vertexArrayObject) {
         build();
     } else {
         checkGlError(glBindVertexArray(vertexArrayObject));
     }
+}
+
+void BufferGeometry::draw() {
+    bindVertexArray();
 
     if(indices != std::nullopt) {
         int dataType = attributeDataTypeToGlType(indices->dataType);
@@ -60,3 +64,25 @@ void BufferGeometry::draw() {
     }
 }
 
+void BufferGeometry::drawIndirect(Buffer& commands, size_t offset) {
+    bindVertexArray();
+    commands.bindAs(Buffer::DrawIndirectBuffer);
+
+    if(indices != std::nullopt) {
+        int dataType = attributeDataTypeToGlType(indices->dataType);
+        checkGlError(glDrawElementsIndirect(GL_TRIANGLES, dataType, (const void*) offset));
+    } else {
+        checkGlError(glDrawArraysIndirect(GL_TRIANGLES, (const void*) offset));
+    }
+}
+
+void BufferGeometry::drawInstanced(uint32_t instances) {
+    bindVertexArray();
+
+    if(indices != std::nullopt) {
+        int dataType = attributeDataTypeToGlType(indices->dataType);
+        checkGlError(glDrawElementsInstanced(GL_TRIANGLES, indices->dataSize, dataType, nullptr, instances));
+    } else {
+        checkGlError(glDrawArraysInstanced(GL_TRIANGLES, 0, attributes[0].dataSize / attributes[0].internalSize, instances));
+    }
+}
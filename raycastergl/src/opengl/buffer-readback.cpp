@@ -0,0 +1,53 @@
+#include <opengl/buffer-readback.hpp>
+#include <glad/glad.h>
+#include <opengl/check-error.hpp>
+
+BufferReadback::BufferReadback(size_t size): size(size) {
+    for(auto& slot : slots) {
+        slot = std::make_unique<Buffer>(Buffer::CopyWriteBuffer, size, Buffer::StreamRead);
+        slot->setTag("readback");
+    }
+}
+
+BufferReadback::~BufferReadback() {
+    for(GLsync fence : fences) {
+        if(fence) {
+            glDeleteSync(fence);
+        }
+    }
+}
+
+void BufferReadback::copyFrom(Buffer& source, size_t offset) {
+    // if all copies are pending, the oldest one is lost
+    if(pending == slotCount) {
+        pending -= 1;
+    }
+
+    if(fences[current]) {
+        checkGlError(glDeleteSync(fences[current]));
+    }
+
+    source.copySubData(*slots[current], offset, 0, size);
+    checkGlError(fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    current = (current + 1) % slotCount;
+    pending += 1;
+}
+
+bool BufferReadback::read(void* data) {
+    if(pending == 0) {
+        return false;
+    }
+
+    const size_t oldest = (current + slotCount - pending) % slotCount;
+    GLenum result;
+    checkGlError(result = glClientWaitSync(fences[oldest], 0, 0));
+    if(result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+        return false;
+    }
+
+    checkGlError(glDeleteSync(fences[oldest]));
+    fences[oldest] = nullptr;
+    slots[oldest]->getSubData(0, data, size);
+    pending -= 1;
+    return true;
+}
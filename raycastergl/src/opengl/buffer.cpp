@@ -1,7 +1,9 @@
 #include <opengl/buffer.hpp>
+#include <algorithm>
 #include <fstream>
 #include <glad/glad.h>
 #include <opengl/check-error.hpp>
+#include <opengl/gpu-memory.hpp>
 
 constexpr int usageToGlUsage(Buffer::Usage usage) {
     switch(usage) {
@@ -23,18 +25,24 @@ constexpr int typeToGlType(Buffer::Type type) {
         case Buffer::ArrayBuffer: return GL_ARRAY_BUFFER;
         case Buffer::ElementArrayBuffer: return GL_ELEMENT_ARRAY_BUFFER;
         case Buffer::ShaderStorageBuffer: return GL_SHADER_STORAGE_BUFFER;
+        case Buffer::DispatchIndirectBuffer: return GL_DISPATCH_INDIRECT_BUFFER;
+        case Buffer::DrawIndirectBuffer: return GL_DRAW_INDIRECT_BUFFER;
+        case Buffer::PixelUnpackBuffer: return GL_PIXEL_UNPACK_BUFFER;
+        case Buffer::PixelPackBuffer: return GL_PIXEL_PACK_BUFFER;
+        case Buffer::CopyWriteBuffer: return GL_COPY_WRITE_BUFFER;
         default: return GL_ARRAY_BUFFER;
     }
 }
 
 Buffer::~Buffer() {
     if(buffer) {
+        GpuMemory::untrack(GpuMemory::Buffers, buffer);
         glDeleteBuffers(1, &buffer);
         buffer = 0;
     }
 
     if(data) {
-        free(data);
+        ::operator delete(data);
         data = nullptr;
     }
 }
@@ -45,6 +53,17 @@ void Buffer::build() {
     checkGlError(glGenBuffers(1, &buffer));
     checkGlError(glBindBuffer(type, buffer));
     checkGlError(glBufferData(type, bufferSize, data, usage));
+    checkGlError(glObjectLabel(GL_BUFFER, buffer, -1, tag));
+    allocated = bufferSize;
+    GpuMemory::track(GpuMemory::Buffers, buffer, tag, allocated);
+}
+
+void Buffer::setTag(const char* tag) {
+    this->tag = tag;
+    if(buffer) {
+        GpuMemory::setTag(GpuMemory::Buffers, buffer, tag);
+        checkGlError(glObjectLabel(GL_BUFFER, buffer, -1, tag));
+    }
 }
 
 void Buffer::bind() {
@@ -55,6 +74,14 @@ void Buffer::bind() {
     checkGlError(glBindBuffer(typeToGlType(type), buffer));
 }
 
+void Buffer::bindAs(Type target) {
+    if(!buffer) {
+        build();
+    }
+
+    checkGlError(glBindBuffer(typeToGlType(target), buffer));
+}
+
 void Buffer::bindBase(uint32_t index) {
     if(!buffer) {
         build();
@@ -64,15 +91,58 @@ void Buffer::bindBase(uint32_t index) {
 }
 
 void Buffer::setData(const void* data, size_t size) {
+    // the CPU copy goes through operator new, so --check-allocations counts it
     if(bufferSize < size || !this->data) {
-        this->data = realloc(this->data, size);
+        ::operator delete(this->data);
+        this->data = ::operator new(size);
     }
 
-    auto type = typeToGlType(this->type);
-    auto usage = usageToGlUsage(this->usage);
     memcpy(this->data, data, size);
     bufferSize = size;
-    checkGlError(glBufferData(type, bufferSize, data, usage));
+    if(!buffer) {
+        build();
+        return;
+    }
+
+    bind();
+    auto type = typeToGlType(this->type);
+    if(size <= allocated) {
+        checkGlError(glBufferSubData(type, 0, size, data));
+        return;
+    }
+
+    checkGlError(glBufferData(type, bufferSize, data, usageToGlUsage(this->usage)));
+    allocated = bufferSize;
+    GpuMemory::track(GpuMemory::Buffers, buffer, tag, allocated);
+}
+
+void Buffer::setSubData(size_t offset, const void* data, size_t size) {
+    bind();
+    if(this->data) {
+        memcpy((uint8_t*) this->data + offset, data, size);
+    }
+
+    checkGlError(glBufferSubData(typeToGlType(type), offset, size, data));
+}
+
+void Buffer::reserve(size_t size) {
+    if(buffer && size <= allocated) {
+        return;
+    }
+
+    // the CPU copy would not have the size of the new storage
+    ::operator delete(data);
+    data = nullptr;
+    bufferSize = std::max(bufferSize, size);
+    if(!buffer) {
+        build();
+        return;
+    }
+
+    bind();
+    checkGlError(glBufferData(typeToGlType(type), bufferSize, nullptr, usageToGlUsage(usage)));
+    allocated = bufferSize;
+    GpuMemory::track(GpuMemory::Buffers, buffer, tag, allocated);
 }
 
 void Buffer::mapBuffer(const std::function<void(const void* const)>& func) {
@@ -91,6 +161,45 @@ void Buffer::mapWritableBuffer(const std::function<void(void*)>& func) {
     glUnmapBuffer(type);
 }
 
+void Buffer::mapForOverwrite(size_t size, const std::function<void(void*)>& func) {
+    bind();
+    auto type = typeToGlType(this->type);
+    GLvoid* p = checkGlError(glMapBufferRange(type, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    func(p);
+    checkGlError(glUnmapBuffer(type));
+}
+
+const void* Buffer::mapForRead() {
+    bind();
+    const void* p;
+    checkGlError(p = glMapBufferRange(typeToGlType(type), 0, bufferSize, GL_MAP_READ_BIT));
+    return p;
+}
+
+void Buffer::unmap() {
+    bind();
+    checkGlError(glUnmapBuffer(typeToGlType(type)));
+}
+
+void Buffer::copySubData(Buffer& destination, size_t offset, size_t destinationOffset, size_t size) {
+    if(!buffer) {
+        build();
+    }
+
+    destination.bindAs(CopyWriteBuffer);
+    checkGlError(glBindBuffer(GL_COPY_READ_BUFFER, buffer));
+    checkGlError(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, destinationOffset, size));
+}
+
+void Buffer::getSubData(size_t offset, void* data, size_t size) {
+    bind();
+    checkGlError(glGetBufferSubData(typeToGlType(type), offset, size, data));
+}
+
+void Buffer::unbind(Type target) {
+    checkGlError(glBindBuffer(typeToGlType(target), 0));
+}
+
 void Buffer::_writeContentsToFile(const char* fileName) {
     mapBuffer([this, fileName] (const void* const ptr) {
         std::ofstream ff("yes.bin");
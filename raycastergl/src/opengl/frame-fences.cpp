@@ -0,0 +1,38 @@
+#include <opengl/frame-fences.hpp>
+#include <algorithm>
+#include <glad/glad.h>
+#include <opengl/check-error.hpp>
+
+FrameFences::FrameFences(uint32_t maxFramesInFlight): maxFramesInFlight(std::min(maxFramesInFlight, maxFrames)) {}
+
+FrameFences::~FrameFences() {
+    for(uint32_t i = 0; i < count; i++) {
+        glDeleteSync(fences[(oldest + i) % maxFrames]);
+    }
+}
+
+void FrameFences::frameSubmitted() {
+    if(maxFramesInFlight == 0) {
+        return;
+    }
+
+    GLsync& fence = fences[(oldest + count) % maxFrames];
+    checkGlError(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    count += 1;
+}
+
+void FrameFences::waitForFrameSlot() {
+    while(maxFramesInFlight != 0 && count >= maxFramesInFlight) {
+        GLsync fence = fences[oldest];
+        // the flush makes sure the fence reaches the GPU, or the wait would never end
+        GLenum result;
+        do {
+            checkGlError(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100'000'000));
+        } while(result == GL_TIMEOUT_EXPIRED);
+
+        checkGlError(glDeleteSync(fence));
+        fences[oldest] = nullptr;
+        oldest = (oldest + 1) % maxFrames;
+        count -= 1;
+    }
+}
@@ -0,0 +1,60 @@
+#include <opengl/frame-readback.hpp>
+#include <glad/glad.h>
+#include <opengl/check-error.hpp>
+
+FrameReadback::~FrameReadback() {
+    for(GLsync fence : fences) {
+        if(fence) {
+            glDeleteSync(fence);
+        }
+    }
+}
+
+void FrameReadback::copyFrom(Framebuffer& framebuffer) {
+    // if all copies are pending, the oldest one is lost
+    if(pending == slotCount) {
+        pending -= 1;
+    }
+
+    if(fences[current]) {
+        checkGlError(glDeleteSync(fences[current]));
+        fences[current] = nullptr;
+    }
+
+    // like the render target, the buffers only grow
+    const glm::uvec2 size(framebuffer.getSize());
+    const size_t bytes = size_t(size.x) * size.y * 4;
+    if(!slots[current] || slots[current]->size() < bytes) {
+        slots[current] = std::make_unique<Buffer>(Buffer::PixelPackBuffer, bytes, Buffer::StreamRead);
+        slots[current]->setTag("frame readback");
+    }
+
+    slots[current]->bind();
+    framebuffer.readPixels(nullptr);
+    Buffer::unbind(Buffer::PixelPackBuffer);
+    sizes[current] = size;
+    checkGlError(fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    current = (current + 1) % slotCount;
+    pending += 1;
+}
+
+bool FrameReadback::read(std::vector<uint8_t>& pixels, glm::uvec2& size) {
+    if(pending == 0) {
+        return false;
+    }
+
+    const size_t oldest = (current + slotCount - pending) % slotCount;
+    GLenum result;
+    checkGlError(result = glClientWaitSync(fences[oldest], 0, 0));
+    if(result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+        return false;
+    }
+
+    checkGlError(glDeleteSync(fences[oldest]));
+    fences[oldest] = nullptr;
+    size = sizes[oldest];
+    pixels.resize(size_t(size.x) * size.y * 4);
+    slots[oldest]->getSubData(0, pixels.data(), pixels.size());
+    pending -= 1;
+    return true;
+}
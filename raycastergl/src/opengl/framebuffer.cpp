@@ -0,0 +1,81 @@
+#include <opengl/framebuffer.hpp>
+#include <glad/glad.h>
+#include <opengl/check-error.hpp>
+#include <opengl/gpu-memory.hpp>
+
+Framebuffer::Framebuffer(): colorTexture(Texture::_2D), size(0, 0) {}
+
+Framebuffer::~Framebuffer() {
+    if(framebuffer) {
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+
+    if(depthRenderbuffer) {
+        GpuMemory::untrack(GpuMemory::Renderbuffers, depthRenderbuffer);
+        glDeleteRenderbuffers(1, &depthRenderbuffer);
+        depthRenderbuffer = 0;
+    }
+}
+
+void Framebuffer::setTag(const char* tag) {
+    colorTexture.setTag(tag);
+    if(depthRenderbuffer) {
+        GpuMemory::setTag(GpuMemory::Renderbuffers, depthRenderbuffer, tag);
+    }
+}
+
+void Framebuffer::resize(ivec2 size) {
+    this->size = size;
+    if(!framebuffer) {
+        checkGlError(glGenFramebuffers(1, &framebuffer));
+        checkGlError(glGenRenderbuffers(1, &depthRenderbuffer));
+    }
+
+    // only the section of the size is rendered and blitted, so smaller sizes reuse the attachments
+    colorTexture.bind();
+    colorTexture.setMinFilter(Texture::Nearest);
+    colorTexture.setMagFilter(Texture::Nearest);
+    if(!colorTexture.reserveImage2D(Texture::RGBA8, size)) {
+        return;
+    }
+
+    capacity = ivec2(colorTexture.getStorageSize().x, colorTexture.getStorageSize().y);
+    checkGlError(glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer));
+    checkGlError(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, capacity.x, capacity.y));
+    // the depth is stored in 4 bytes by most drivers
+    GpuMemory::track(GpuMemory::Renderbuffers, depthRenderbuffer, colorTexture.tag, size_t(capacity.x) * capacity.y * 4);
+
+    bind();
+    checkGlError(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture.texture, 0));
+    checkGlError(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer));
+#ifndef NDEBUG
+    assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE /* Ensure the framebuffer is complete */);
+#endif
+}
+
+void Framebuffer::bind() {
+    checkGlError(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+}
+
+void Framebuffer::blitToScreen(ivec2 pos, ivec2 size, bool linear) {
+    checkGlError(glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer));
+    checkGlError(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0));
+    checkGlError(glBlitFramebuffer(
+        0, 0, this->size.x, this->size.y,
+        pos.x, pos.y, pos.x + size.x, pos.y + size.y,
+        GL_COLOR_BUFFER_BIT,
+        linear ? GL_LINEAR : GL_NEAREST
+    ));
+}
+
+void Framebuffer::readPixels(void* data) {
+    checkGlError(glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer));
+    // the rows of RGBA8 are always aligned to 4 bytes, there is no padding
+    checkGlError(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+    checkGlError(glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, data));
+}
+
+void Framebuffer::bindScreen() {
+    checkGlError(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
@@ -0,0 +1,89 @@
+#include <opengl/gpu-memory.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+struct Allocation {
+    GpuMemory::Kind kind;
+    const char* tag;
+    size_t bytes;
+};
+
+// the handles of each kind are independent, so the kind is part of the key
+static std::unordered_map<uint64_t, Allocation> allocations;
+static size_t totals[GpuMemory::KindCount] = { 0 };
+
+static uint64_t key(GpuMemory::Kind kind, uint32_t handle) {
+    return (uint64_t(kind) << 32) | handle;
+}
+
+static double toMiB(size_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+size_t GpuMemory::Usage::totalBytes() const {
+    size_t total = 0;
+    for(size_t b : bytes) {
+        total += b;
+    }
+
+    return total;
+}
+
+void GpuMemory::track(Kind kind, uint32_t handle, const char* tag, size_t bytes) {
+    auto [it, inserted] = allocations.try_emplace(key(kind, handle), Allocation { kind, tag, 0 });
+    totals[kind] += bytes - it->second.bytes;
+    it->second.bytes = bytes;
+}
+
+void GpuMemory::setTag(Kind kind, uint32_t handle, const char* tag) {
+    if(auto it = allocations.find(key(kind, handle)); it != allocations.end()) {
+        it->second.tag = tag;
+    }
+}
+
+void GpuMemory::untrack(Kind kind, uint32_t handle) {
+    if(auto it = allocations.find(key(kind, handle)); it != allocations.end()) {
+        totals[kind] -= it->second.bytes;
+        allocations.erase(it);
+    }
+}
+
+size_t GpuMemory::totalBytes(Kind kind) {
+    return totals[kind];
+}
+
+std::vector<GpuMemory::Usage> GpuMemory::usageByTag() {
+    std::vector<Usage> usages;
+    for(const auto& [_, allocation] : allocations) {
+        auto usage = std::find_if(usages.begin(), usages.end(), [&allocation] (const Usage& u) {
+            return strcmp(u.tag, allocation.tag) == 0;
+        });
+        if(usage == usages.end()) {
+            usage = usages.insert(usages.end(), Usage { allocation.tag, { 0 }, 0 });
+        }
+
+        usage->bytes[allocation.kind] += allocation.bytes;
+        usage->objects += 1;
+    }
+
+    std::sort(usages.begin(), usages.end(), [] (const Usage& a, const Usage& b) {
+        return a.totalBytes() > b.totalBytes();
+    });
+    return usages;
+}
+
+void GpuMemory::printReport() {
+    printf(
+        "\r> GPU memory: %.2f MiB (buffers %.2f MiB, textures %.2f MiB, renderbuffers %.2f MiB)\n",
+        toMiB(totals[Buffers] + totals[Textures] + totals[Renderbuffers]),
+        toMiB(totals[Buffers]),
+        toMiB(totals[Textures]),
+        toMiB(totals[Renderbuffers])
+    );
+    for(const auto& usage : usageByTag()) {
+        printf("    %-20s %9.2f MiB  (%u objects)\n", usage.tag, toMiB(usage.totalBytes()), usage.objects);
+    }
+    fflush(stdout);
+}
@@ -0,0 +1,64 @@
+#include <opengl/gpu-pool.hpp>
+#include <algorithm>
+
+static constexpr const char poolTag[] = "pool";
+
+std::shared_ptr<Texture> GpuPool::acquireTexture2D(Texture::InternalFormat format, ivec2 size, const char* tag) {
+    auto it = std::find_if(textures.begin(), textures.end(), [format, size] (const auto& texture) {
+        const ivec3 storage = texture->getStorageSize();
+        return texture->getType() == Texture::_2D
+            && texture->getInternalFormat() == format
+            && storage.x == size.x
+            && storage.y == size.y;
+    });
+    if(it == textures.end()) {
+        return nullptr;
+    }
+
+    auto texture = std::move(*it);
+    textures.erase(it);
+    texture->setTag(tag);
+    return texture;
+}
+
+std::shared_ptr<Buffer> GpuPool::acquireBuffer(Buffer::Type type, size_t size, const char* tag) {
+    // the smallest one that fits, so the big ones are kept for the big requests
+    auto best = buffers.end();
+    for(auto it = buffers.begin(); it != buffers.end(); it++) {
+        if((*it)->getType() == type && (*it)->capacity() >= size && (best == buffers.end() || (*it)->capacity() < (*best)->capacity())) {
+            best = it;
+        }
+    }
+    if(best == buffers.end()) {
+        return nullptr;
+    }
+
+    auto buffer = std::move(*best);
+    buffers.erase(best);
+    buffer->setTag(tag);
+    return buffer;
+}
+
+void GpuPool::release(std::shared_ptr<Texture> texture) {
+    if(!texture) {
+        return;
+    }
+
+    texture->setTag(poolTag);
+    textures.push_back(std::move(texture));
+    if(textures.size() > maxObjects) {
+        textures.pop_front();
+    }
+}
+
+void GpuPool::release(std::shared_ptr<Buffer> buffer) {
+    if(!buffer) {
+        return;
+    }
+
+    buffer->setTag(poolTag);
+    buffers.push_back(std::move(buffer));
+    if(buffers.size() > maxObjects) {
+        buffers.pop_front();
+    }
+}
@@ -0,0 +1,47 @@
+#include <opengl/gpu-timer.hpp>
+#include <glad/glad.h>
+#include <opengl/check-error.hpp>
+
+GpuTimer::~GpuTimer() {
+    if(queries[0]) {
+        glDeleteQueries(queryCount, queries);
+        queries[0] = 0;
+    }
+}
+
+void GpuTimer::begin() {
+    if(!queries[0]) {
+        checkGlError(glGenQueries(queryCount, queries));
+    }
+
+    // if all queries are in use, the oldest result is lost
+    if(pending == queryCount) {
+        pending -= 1;
+    }
+
+    checkGlError(glBeginQuery(GL_TIME_ELAPSED, queries[current]));
+}
+
+void GpuTimer::end() {
+    checkGlError(glEndQuery(GL_TIME_ELAPSED));
+    current = (current + 1) % queryCount;
+    pending += 1;
+}
+
+std::optional<double> GpuTimer::getElapsedMs() {
+    if(pending == 0) {
+        return std::nullopt;
+    }
+
+    uint32_t query = queries[(current + queryCount - pending) % queryCount];
+    int available = 0;
+    checkGlError(glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available));
+    if(!available) {
+        return std::nullopt;
+    }
+
+    uint64_t elapsed;
+    checkGlError(glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed));
+    pending -= 1;
+    return elapsed / 1000000.0;
+}
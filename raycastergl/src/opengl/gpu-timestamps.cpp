@@ -0,0 +1,63 @@
+#include <opengl/gpu-timestamps.hpp>
+#include <glad/glad.h>
+#include <opengl/check-error.hpp>
+
+GpuTimestamps::GpuTimestamps(size_t sectionCount):
+    sectionCount(sectionCount),
+    queries(frameCount * (sectionCount + 1), 0) {}
+
+GpuTimestamps::~GpuTimestamps() {
+    if(queries[0]) {
+        glDeleteQueries(queries.size(), queries.data());
+        queries[0] = 0;
+    }
+}
+
+void GpuTimestamps::beginFrame() {
+    if(!queries[0]) {
+        checkGlError(glGenQueries(queries.size(), queries.data()));
+    }
+
+    // if all frames are in use, the oldest result is lost
+    if(pending == frameCount) {
+        pending -= 1;
+    }
+
+    checkGlError(glQueryCounter(queries[current * (sectionCount + 1)], GL_TIMESTAMP));
+    nextMark = 1;
+}
+
+void GpuTimestamps::endSection() {
+    checkGlError(glQueryCounter(queries[current * (sectionCount + 1) + nextMark], GL_TIMESTAMP));
+    nextMark += 1;
+    if(nextMark > sectionCount) {
+        current = (current + 1) % frameCount;
+        pending += 1;
+    }
+}
+
+bool GpuTimestamps::getSectionsMs(std::vector<double>& sectionsMs) {
+    if(pending == 0) {
+        return false;
+    }
+
+    const uint32_t* frame = &queries[((current + frameCount - pending) % frameCount) * (sectionCount + 1)];
+    // the last timestamp is the last one to finish
+    int available = 0;
+    checkGlError(glGetQueryObjectiv(frame[sectionCount], GL_QUERY_RESULT_AVAILABLE, &available));
+    if(!available) {
+        return false;
+    }
+
+    uint64_t previous;
+    checkGlError(glGetQueryObjectui64v(frame[0], GL_QUERY_RESULT, &previous));
+    for(size_t i = 0; i < sectionCount; i++) {
+        uint64_t timestamp;
+        checkGlError(glGetQueryObjectui64v(frame[i + 1], GL_QUERY_RESULT, &timestamp));
+        sectionsMs[i] = (timestamp - previous) / 1000000.0;
+        previous = timestamp;
+    }
+
+    pending -= 1;
+    return true;
+}
@@ -34,6 +34,25 @@ bool ShaderProgram::link(const std::initializer_list<Shader*>& shaders) const {
     return true;
 }
 
+bool ShaderProgram::checkBufferLayout(const char* variable, size_t offset, size_t arrayStride) const {
+    uint32_t index = checkGlError(glGetProgramResourceIndex(program, GL_BUFFER_VARIABLE, variable));
+    if(index == GL_INVALID_INDEX) {
+        std::cerr << "Buffer variable " << variable << " not found in program " << name << std::endl;
+        return false;
+    }
+
+    const GLenum properties[] = { GL_OFFSET, GL_TOP_LEVEL_ARRAY_STRIDE };
+    int values[2];
+    checkGlError(glGetProgramResourceiv(program, GL_BUFFER_VARIABLE, index, 2, properties, 2, nullptr, values));
+    if(size_t(values[0]) != offset || size_t(values[1]) != arrayStride) {
+        std::cerr << "Buffer variable " << variable << " of program " << name << " has offset " << values[0]
+                  << " and stride " << values[1] << ", but " << offset << " and " << arrayStride << " were expected" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 void ShaderProgram::checkProgramIsBound() {
 #ifndef NDEBUG
     int p;
@@ -75,7 +94,23 @@ void ShaderProgram::dispatchCompute(uint32_t x, uint32_t y, uint32_t z) {
     checkGlError(glDispatchCompute(x, y, z));
 }
 
+void ShaderProgram::dispatchComputeIndirect(Buffer& commands, size_t offset) {
+    checkProgramIsBound();
+    commands.bindAs(Buffer::DispatchIndirectBuffer);
+    checkGlError(glDispatchComputeIndirect(offset));
+}
+
+void ShaderProgram::setUniform(const char* name, const glm::vec3& v) {
+    checkProgramIsBound();
+    checkGlError(glUniform3f(getUniformLocation(name), v.x, v.y, v.z));
+}
+
 void ShaderProgram::setUniform(const char* name, const glm::vec4& v) {
     checkProgramIsBound();
     checkGlError(glUniform4f(getUniformLocation(name), v.x, v.y, v.z, v.w));
 }
+
+void ShaderProgram::setUniform(const char* name, float x) {
+    checkProgramIsBound();
+    checkGlError(glUniform1f(getUniformLocation(name), x));
+}
@@ -1,5 +1,7 @@
 #include <opengl/shader.hpp>
+#include <algorithm>
 #include <iostream>
+#include <unordered_map>
 #include <glad/glad.h>
 #include <utils/files.hpp>
 #include <opengl/check-error.hpp>
@@ -13,6 +15,9 @@ constexpr int typeToGl(Shader::Type type) {
     }
 }
 
+// code generated from the C++ side, it can be included as if it were a file
+static std::unordered_map<std::string, std::string> generatedIncludes;
+
 Shader::Shader(Shader::Type type) {
     checkGlError(shader = glCreateShader(typeToGl(type)));
 }
@@ -24,21 +29,96 @@ Shader::~Shader() {
     }
 }
 
-bool Shader::load(const fs::path& path) {
+bool Shader::load(const fs::path& path, const Defines& defines) {
     this->path = path;
     std::cout << "> Loading shader " << path << std::endl;
-    auto content = readFile("res/shaders" / path);
-    if(content == std::nullopt) {
-        std::cerr << "Could not read shader " << path << std::endl;
+    sources.clear();
+
+    std::string content;
+    std::unordered_set<std::string> included;
+    if(!preprocess(path, content, included)) {
         return false;
     }
 
-    const auto src = content->c_str();
+    if(!defines.empty()) {
+        // #version must be the first line, and #line keeps the line numbers of the errors right
+        size_t versionLine = content.find("#version");
+        size_t versionEnd = content.find('\n', versionLine);
+        if(versionLine == std::string::npos || versionEnd == std::string::npos) {
+            std::cerr << "Shader " << path << " does not have a #version line" << std::endl;
+            return false;
+        }
+
+        std::string definesCode;
+        for(const auto& [name, value] : defines) {
+            definesCode += "#define " + name + " " + value + "\n";
+        }
+
+        size_t nextLine = std::count(content.begin(), content.begin() + versionEnd, '\n') + 2;
+        content.insert(versionEnd + 1, definesCode + "#line " + std::to_string(nextLine) + " 0\n");
+    }
+
+    const auto src = content.c_str();
     checkGlError(glShaderSource(shader, 1, &src, nullptr));
 
     return true;
 }
 
+bool Shader::preprocess(const fs::path& path, std::string& output, std::unordered_set<std::string>& included) {
+    // the files are read directly from the mapped memory, only the final source is copied
+    std::optional<MappedFile> file;
+    std::string_view content;
+    auto generated = generatedIncludes.find(path.generic_string());
+    if(generated != generatedIncludes.end()) {
+        content = generated->second;
+    } else {
+        file = MappedFile::open(resourcePath("shaders") / path);
+        if(file == std::nullopt) {
+            std::cerr << "Could not read shader " << path << std::endl;
+            return false;
+        }
+        content = file->view();
+    }
+
+    const size_t sourceNumber = sources.size();
+    sources.push_back(path);
+    output.reserve(output.size() + content.size());
+
+    size_t lineNumber = 0;
+    while(!content.empty()) {
+        size_t lineEnd = content.find('\n');
+        std::string_view line = content.substr(0, lineEnd);
+        content.remove_prefix(lineEnd == std::string_view::npos ? content.size() : lineEnd + 1);
+        lineNumber += 1;
+
+        size_t directive = line.find_first_not_of(" \t");
+        if(directive == std::string_view::npos || line.compare(directive, 8, "#include") != 0) {
+            output += line;
+            output += '\n';
+            continue;
+        }
+
+        size_t nameStart = line.find('"', directive);
+        size_t nameEnd = nameStart == std::string_view::npos ? nameStart : line.find('"', nameStart + 1);
+        if(nameEnd == std::string_view::npos) {
+            std::cerr << path.string() << ":" << lineNumber << ": invalid #include" << std::endl;
+            return false;
+        }
+
+        const std::string name(line.substr(nameStart + 1, nameEnd - nameStart - 1));
+        if(included.insert(name).second) {
+            output += "#line 1 " + std::to_string(sources.size()) + "\n";
+            if(!preprocess(name, output, included)) {
+                return false;
+            }
+        }
+
+        output += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(sourceNumber) + "\n";
+    }
+
+    return true;
+}
+
 bool Shader::compile() const {
     std::cout << "> Compiling shader " << path << std::endl;
     checkGlError(glCompileShader(shader));
@@ -49,8 +129,18 @@ bool Shader::compile() const {
     if(!success) {
         glGetShaderInfoLog(shader, 1024, nullptr, infoLog);
         std::cerr << "Could not compile shader " << path << ":" << std::endl << infoLog << std::endl;
+        if(sources.size() > 1) {
+            // the first number of the errors is the source (the file)
+            for(size_t i = 0; i < sources.size(); i += 1) {
+                std::cerr << "  " << i << ": " << sources[i].string() << std::endl;
+            }
+        }
         return false;
     }
 
     return true;
 }
+
+void Shader::addGeneratedInclude(const std::string& name, const std::string& content) {
+    generatedIncludes[name] = content;
+}
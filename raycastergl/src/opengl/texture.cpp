@@ -1,6 +1,8 @@
 #include <opengl/texture.hpp>
+#include <algorithm>
 #include <glad/glad.h>
 #include <opengl/check-error.hpp>
+#include <opengl/gpu-memory.hpp>
 
 constexpr int wrapToGlWrap(Texture::Wrap wrap) {
     switch(wrap) {
@@ -28,6 +30,7 @@ constexpr int formatToGlFormat(Texture::InternalFormat format) {
     switch(format) {
         case Texture::R8UI: return GL_R8UI;
         case Texture::RGBA32F: return GL_RGBA32F;
+        case Texture::RGBA8: return GL_RGBA8;
         default: return GL_RGB;
     }
 }
@@ -36,6 +39,7 @@ constexpr int formatToGlFormat(Texture::ExternalFormat format) {
     switch(format) {
         case Texture::RedInteger: return GL_RED_INTEGER;
         case Texture::RGB: return GL_RGB;
+        case Texture::RGBA: return GL_RGBA;
         default: return GL_RGB;
     }
 }
@@ -47,7 +51,16 @@ constexpr int dataTypeToGlType(Texture::DataType dataType) {
     }
 }
 
-Texture::Texture(Type type) {
+constexpr size_t formatBytes(Texture::InternalFormat format) {
+    switch(format) {
+        case Texture::R8UI: return 1;
+        case Texture::RGBA32F: return 16;
+        case Texture::RGBA8: return 4;
+        default: return 4;
+    }
+}
+
+Texture::Texture(Type type): textureType(type) {
     switch(type) {
         case Type::_2D: this->type = GL_TEXTURE_2D; break;
         case Type::Array2D: this->type = GL_TEXTURE_2D_ARRAY; break;
@@ -56,11 +69,26 @@ Texture::Texture(Type type) {
 
 Texture::~Texture() {
     if(texture) {
+        GpuMemory::untrack(GpuMemory::Textures, texture);
         glDeleteTextures(1, &texture);
         texture = 0;
     }
 }
 
+void Texture::setStorage(ivec3 size, size_t bytes) {
+    storageSize = size;
+    GpuMemory::track(GpuMemory::Textures, texture, tag, bytes);
+    checkGlError(glObjectLabel(GL_TEXTURE, texture, -1, tag));
+}
+
+void Texture::setTag(const char* tag) {
+    this->tag = tag;
+    if(texture) {
+        GpuMemory::setTag(GpuMemory::Textures, texture, tag);
+        checkGlError(glObjectLabel(GL_TEXTURE, texture, -1, tag));
+    }
+}
+
 void Texture::checkTextureIsBound() {
 #ifndef NDEBUG
     int p, toCheck = GL_TEXTURE_BINDING_2D;
@@ -92,6 +120,10 @@ void Texture::setMagFilter(Filter filter) {
 
 void Texture::fillImage2D(int level, InternalFormat iformat, ivec2 size, int border, ExternalFormat eformat, DataType dataType, const void* data) {
     internalFormat = iformat;
+    // only the first level is counted (the mipmaps are not used with these textures)
+    if(level == 0) {
+        setStorage(ivec3(size.x, size.y, 1), size_t(size.x) * size.y * formatBytes(iformat));
+    }
 
     checkTextureIsBound();
     checkGlError(glTexImage2D(
@@ -107,11 +139,43 @@ void Texture::fillImage2D(int level, InternalFormat iformat, ivec2 size, int bor
     ));
 }
 
+bool Texture::reserveImage2D(InternalFormat format, ivec2 size) {
+    if(storageSize.x > 0 && format == internalFormat && size.x <= storageSize.x && size.y <= storageSize.y) {
+        return false;
+    }
+
+    // grows in both dimensions, so changing the aspect ratio does not replace it again
+    const ivec2 newSize(std::max(size.x, storageSize.x), std::max(size.y, storageSize.y));
+    const ExternalFormat externalFormat = format == R8UI ? RedInteger : RGBA;
+    fillImage2D(0, format, newSize, 0, externalFormat, UnsignedByte, nullptr);
+    return true;
+}
+
+void Texture::fillSubImage2D(int level, ivec2 offset, ivec2 size, ExternalFormat format, DataType dataType, const void* data) {
+    checkTextureIsBound();
+    checkGlError(glTexSubImage2D(
+        type,
+        level,
+        offset.x,
+        offset.y,
+        size.x,
+        size.y,
+        formatToGlFormat(format),
+        dataTypeToGlType(dataType),
+        data
+    ));
+}
+
 void Texture::reserveStorage3D(InternalFormat format, ivec3 size, size_t levels) {
     internalFormat = format;
+    size_t bytes = 0;
+    for(size_t level = 0; level < levels; level++) {
+        bytes += size_t(std::max(size.x >> level, 1)) * std::max(size.y >> level, 1) * size.z * formatBytes(format);
+    }
 
     checkTextureIsBound();
     checkGlError(glTexStorage3D(this->type, levels, formatToGlFormat(format), size.x, size.y, size.z));
+    setStorage(size, bytes);
 }
 
 void Texture::fillSubImage3D(int level, ivec3 offset, ivec3 size, ExternalFormat format, DataType dataType, const void* data) {
@@ -131,6 +195,11 @@ void Texture::fillSubImage3D(int level, ivec3 offset, ivec3 size, ExternalFormat
     ));
 }
 
+void Texture::getImage(int level, ExternalFormat format, DataType dataType, void* data) {
+    checkTextureIsBound();
+    checkGlError(glGetTexImage(type, level, formatToGlFormat(format), dataTypeToGlType(dataType), data));
+}
+
 void Texture::bind() {
     if(!texture) {
         checkGlError(glGenTextures(1, &texture));
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <engine/frame-codec.hpp>
+#include <utils/sockets.hpp>
+
+using Clock = std::chrono::steady_clock;
+
+// the biggest frame accepted from the server (a keyframe of 4K with tiles that do not compress)
+static constexpr uint32_t maxPayloadBytes = 64 * 1024 * 1024;
+
+// writes the image as a binary PPM, the rows are flipped because the frames have them from the bottom
+static bool writePpm(const std::string& path, const FrameDecoder& decoder) {
+    std::ofstream file(path, std::ios::binary);
+    if(!file) {
+        return false;
+    }
+
+    const uvec2 size = decoder.getSize();
+    const auto& pixels = decoder.getPixels();
+    file << "P6\n" << size.x << " " << size.y << "\n255\n";
+    std::vector<char> row(size_t(size.x) * 3);
+    for(uint32_t y = size.y; y > 0; y -= 1) {
+        const uint8_t* rgba = pixels.data() + size_t(y - 1) * size.x * 4;
+        for(uint32_t x = 0; x < size.x; x += 1) {
+            row[x * 3 + 0] = char(rgba[x * 4 + 0]);
+            row[x * 3 + 1] = char(rgba[x * 4 + 1]);
+            row[x * 3 + 2] = char(rgba[x * 4 + 2]);
+        }
+        file.write(row.data(), std::streamsize(row.size()));
+    }
+    return bool(file);
+}
+
+// connects to the stream of the game (--stream), decodes the frames and prints what it receives
+int main(int argc, const char* const argv[]) {
+    if(argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <port or unix:path> [frames] [last-frame.ppm]" << std::endl;
+        return 1;
+    }
+
+    const std::string address = argv[1];
+    const uint64_t maxFrames = argc > 2 ? std::stoull(argv[2]) : 0;
+    const std::string output = argc > 3 ? argv[3] : "";
+
+    intptr_t socket = connectSocket(address);
+    if(socket == invalidSocket) {
+        return 1;
+    }
+
+    std::cout << "> Receiving frames from " << address << std::endl;
+    FrameDecoder decoder;
+    std::vector<uint8_t> payload;
+    uint64_t frames = 0, intervalFrames = 0, intervalBytes = 0, intervalTiles = 0;
+    auto intervalStart = Clock::now();
+    int result = 0;
+    while(maxFrames == 0 || frames < maxFrames) {
+        StreamFrameHeader header;
+        if(!receiveAll(socket, &header, sizeof(header))) {
+            std::cout << "> The server closed the stream" << std::endl;
+            break;
+        }
+
+        if(header.payloadBytes > maxPayloadBytes) {
+            std::cerr << "  Frame " << header.number << " is too big (" << header.payloadBytes << " bytes)" << std::endl;
+            result = 1;
+            break;
+        }
+
+        payload.resize(header.payloadBytes);
+        if(!receiveAll(socket, payload.data(), payload.size())) {
+            std::cerr << "  The stream ended in the middle of frame " << header.number << std::endl;
+            result = 1;
+            break;
+        }
+
+        if(!decoder.decode(header, payload.data())) {
+            std::cerr << "  Frame " << header.number << " is invalid" << std::endl;
+            result = 1;
+            break;
+        }
+
+        frames += 1;
+        intervalFrames += 1;
+        intervalBytes += sizeof(header) + header.payloadBytes;
+        intervalTiles += header.changedTiles;
+
+        const auto now = Clock::now();
+        const double seconds = std::chrono::duration<double>(now - intervalStart).count();
+        if(seconds >= 1.0) {
+            printf(
+                "  %ux%u  %.1f fps  %.1f KiB per frame  %.1f tiles per frame\n",
+                decoder.getSize().x,
+                decoder.getSize().y,
+                intervalFrames / seconds,
+                intervalBytes / 1024.0 / intervalFrames,
+                double(intervalTiles) / intervalFrames
+            );
+            intervalFrames = intervalBytes = intervalTiles = 0;
+            intervalStart = now;
+        }
+    }
+
+    closeSocket(socket);
+    std::cout << "> Received " << frames << " frames" << std::endl;
+    if(!output.empty() && frames > 0) {
+        if(!writePpm(output, decoder)) {
+            std::cerr << "  Could not write " << output << std::endl;
+            return 1;
+        }
+        std::cout << "> Last frame written into " << output << std::endl;
+    }
+
+    return result;
+}
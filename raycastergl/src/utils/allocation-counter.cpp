@@ -0,0 +1,80 @@
+#include <utils/allocation-counter.hpp>
+#include <cstdlib>
+#include <new>
+
+// each thread counts its own allocations, so the render thread is not affected by the workers
+static thread_local uint64_t allocations = 0;
+
+uint64_t threadAllocationCount() {
+    return allocations;
+}
+
+void* operator new(std::size_t size) {
+    allocations += 1;
+    if(void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    allocations += 1;
+    // the size of aligned_alloc must be a multiple of the alignment
+    const std::size_t align = std::size_t(alignment);
+    const std::size_t alignedSize = (size + align - 1) / align * align;
+#ifdef WIN32
+    void* ptr = _aligned_malloc(alignedSize ? alignedSize : align, align);
+#else
+    void* ptr = std::aligned_alloc(align, alignedSize ? alignedSize : align);
+#endif
+    if(ptr) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+#ifdef WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept {
+    operator delete(ptr, alignment);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(ptr, alignment);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(ptr, alignment);
+}
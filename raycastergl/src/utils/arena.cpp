@@ -0,0 +1,20 @@
+#include <utils/arena.hpp>
+
+Arena::Arena(size_t capacity): memory(new uint8_t[capacity]), capacity(capacity) {}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+    size_t start = (used + alignment - 1) & ~(alignment - 1);
+    if(start + size > capacity) {
+        return ::operator new(size);
+    }
+
+    used = start + size;
+    return memory.get() + start;
+}
+
+void Arena::deallocate(void* ptr) {
+    // the memory of the arena is freed with it
+    if(!owns(ptr)) {
+        ::operator delete(ptr);
+    }
+}
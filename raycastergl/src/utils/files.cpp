@@ -1,45 +1,139 @@
+#include <cstring>
 #include <filesystem>
-#include <fstream>
 #include <optional>
-#include <sstream>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "utils/files.hpp"
 
 using namespace std;
 namespace fs = std::filesystem;
 
-optional<string> readFile(const fs::path& path) {
+static fs::path resourceDirectory = "res";
+
+void setResourceDirectory(const fs::path& directory) {
+    resourceDirectory = directory;
+}
+
+fs::path resourcePath(const fs::path& relative) {
+    return resourceDirectory / relative;
+}
+
+MappedFile::~MappedFile() {
+    if(address) {
+#ifdef WIN32
+        UnmapViewOfFile(address);
+#else
+        munmap((void*) address, length);
+#endif
+        address = nullptr;
+    }
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& o) {
+    if(this != &o) {
+        this->~MappedFile();
+        address = o.address;
+        length = o.length;
+        o.address = nullptr;
+        o.length = 0;
+    }
+
+    return *this;
+}
+
+optional<MappedFile> MappedFile::open(const fs::path& path) {
     if(!fs::is_regular_file(path)) {
         return nullopt;
     }
 
-    ifstream stream(path);
-    if(!stream.is_open()) {
+#ifdef WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) {
+        return nullopt;
+    }
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return nullopt;
+    }
+
+    // empty files cannot be mapped
+    if(fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return MappedFile(nullptr, 0);
+    }
+
+    // the view keeps the mapping (and the file) alive, so the handles are not needed after this
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if(mapping == nullptr) {
+        return nullopt;
+    }
+
+    void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if(address == nullptr) {
+        return nullopt;
+    }
+
+    return MappedFile((const uint8_t*) address, size_t(fileSize.QuadPart));
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd == -1) {
+        return nullopt;
+    }
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) == -1) {
+        close(fd);
         return nullopt;
     }
 
-    stringstream stringStream;
-    for(string line; getline(stream, line); ) {
-        stringStream << line << endl;
+    // empty files cannot be mapped
+    if(fileStat.st_size == 0) {
+        close(fd);
+        return MappedFile(nullptr, 0);
     }
 
-    stream.close();
-    return stringStream.str();
+    // the mapping keeps the file alive, so the descriptor is not needed after this
+    void* address = mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(address == MAP_FAILED) {
+        return nullopt;
+    }
+
+    // the files are read from the start to the end
+    madvise(address, size_t(fileStat.st_size), MADV_SEQUENTIAL);
+    return MappedFile((const uint8_t*) address, size_t(fileStat.st_size));
+#endif
 }
 
-std::optional<BinaryData> readFileBinary(const fs::path& path) {
-    if(!fs::is_regular_file(path)) {
+optional<string> readFile(const fs::path& path) {
+    auto file = MappedFile::open(path);
+    if(file == nullopt) {
         return nullopt;
     }
 
-    ifstream stream(path);
-    if(!stream.is_open()) {
+    return string(file->view());
+}
+
+std::optional<BinaryData> readFileBinary(const fs::path& path) {
+    auto file = MappedFile::open(path);
+    if(file == nullopt) {
         return nullopt;
     }
 
-    auto fileSize = size_t(fs::file_size(path));
-    shared_ptr<uint8_t[]> data(new uint8_t[fileSize]);
-    stream.read((char*) (void*) data.get(), fileSize);
+    shared_ptr<uint8_t[]> data(new uint8_t[file->size()]);
+    if(file->size() > 0) {
+        memcpy(data.get(), file->data(), file->size());
+    }
 
-    stream.close();
-    return {{ data, fileSize }};
+    return {{ data, file->size() }};
 }
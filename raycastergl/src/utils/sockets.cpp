@@ -0,0 +1,266 @@
+#include <utils/sockets.hpp>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <utility>
+#ifdef WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static constexpr const char unixPrefix[] = "unix:";
+
+static inline bool isUnixAddress(const std::string& address) {
+    return address.rfind(unixPrefix, 0) == 0;
+}
+
+#ifdef WIN32
+static bool startSockets(const char* what) {
+    WSADATA wsaData;
+    if(WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::cerr << "  Could not initialize the sockets for the " << what << std::endl;
+        return false;
+    }
+    return true;
+}
+#endif
+
+// creates the socket and fills the address, returns invalidSocket if the address is not valid
+static intptr_t createSocket(const std::string& address, sockaddr_storage& socketAddress, socklen_t& addressSize, const char* what) {
+    socketAddress = {};
+    if(isUnixAddress(address)) {
+#ifndef WIN32
+        auto& unixAddress = (sockaddr_un&) socketAddress;
+        unixAddress.sun_family = AF_UNIX;
+        const std::string path = address.substr(strlen(unixPrefix));
+        if(path.empty() || path.size() >= sizeof(unixAddress.sun_path)) {
+            std::cerr << "  Invalid path for the " << what << " socket: " << path << std::endl;
+            return invalidSocket;
+        }
+
+        memcpy(unixAddress.sun_path, path.c_str(), path.size());
+        addressSize = sizeof(sockaddr_un);
+        return intptr_t(socket(AF_UNIX, SOCK_STREAM, 0));
+#else
+        std::cerr << "  Unix sockets are not supported in Windows (for the " << what << ")" << std::endl;
+        return invalidSocket;
+#endif
+    }
+
+    auto& inetAddress = (sockaddr_in&) socketAddress;
+    inetAddress.sin_family = AF_INET;
+    inetAddress.sin_port = htons(uint16_t(std::stoi(address)));
+    inetAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addressSize = sizeof(sockaddr_in);
+    return intptr_t(socket(AF_INET, SOCK_STREAM, 0));
+}
+
+#ifndef WIN32
+// the files of the Unix sockets opened by this process (by listen socket), only they are removed when closing
+static std::mutex socketFilesMutex;
+static std::map<intptr_t, std::pair<dev_t, ino_t>> socketFiles;
+
+// a socket file left by a run that ended is removed, so the bind does not fail. Returns false if the path is
+// something else (a regular file) or the socket of a server that is still running
+static bool removeStaleSocket(const std::string& address, const char* what) {
+    const std::string path = address.substr(strlen(unixPrefix));
+    struct stat info;
+    if(lstat(path.c_str(), &info) != 0) {
+        return true;
+    }
+
+    if(!S_ISSOCK(info.st_mode)) {
+        std::cerr << "  Could not open the " << what << " socket " << address << ": the file exists and is not a socket" << std::endl;
+        return false;
+    }
+
+    sockaddr_storage socketAddress;
+    socklen_t addressSize = 0;
+    intptr_t probe = createSocket(address, socketAddress, addressSize, what);
+    if(probe == invalidSocket) {
+        return false;
+    }
+
+    const bool running = connect(int(probe), (const sockaddr*) &socketAddress, addressSize) == 0;
+    closeSocket(probe);
+    if(running) {
+        std::cerr << "  Could not open the " << what << " socket " << address << ": another process is using it" << std::endl;
+        return false;
+    }
+
+    unlink(path.c_str());
+    return true;
+}
+#endif
+
+intptr_t openListenSocket(const std::string& address, const char* what) {
+#ifdef WIN32
+    if(!startSockets(what)) {
+        return invalidSocket;
+    }
+#endif
+
+    sockaddr_storage socketAddress;
+    socklen_t addressSize = 0;
+#ifndef WIN32
+    if(isUnixAddress(address) && !removeStaleSocket(address, what)) {
+        return invalidSocket;
+    }
+#endif
+    intptr_t fd = createSocket(address, socketAddress, addressSize, what);
+    int result = -1;
+    if(fd != invalidSocket) {
+        const int reuse = 1;
+        if(!isUnixAddress(address)) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const char*) &reuse, sizeof(reuse));
+        }
+        result = bind(fd, (const sockaddr*) &socketAddress, addressSize);
+    }
+
+    if(result != 0 || listen(fd, 4) != 0) {
+        std::cerr << "  Could not open the " << what << " socket " << address << ": " << strerror(errno) << std::endl;
+        if(fd != invalidSocket) {
+            closeSocket(fd);
+        }
+#ifdef WIN32
+        WSACleanup();
+#endif
+        return invalidSocket;
+    }
+
+#ifndef WIN32
+    struct stat info;
+    if(isUnixAddress(address) && lstat(address.c_str() + strlen(unixPrefix), &info) == 0) {
+        std::lock_guard<std::mutex> lock(socketFilesMutex);
+        socketFiles[fd] = { info.st_dev, info.st_ino };
+    }
+#endif
+    return fd;
+}
+
+void closeListenSocket(intptr_t socket, const std::string& address) {
+    closeSocket(socket);
+#ifndef WIN32
+    if(!isUnixAddress(address)) {
+        return;
+    }
+
+    // the file is removed only if it is still the socket created by this process
+    std::lock_guard<std::mutex> lock(socketFilesMutex);
+    auto file = socketFiles.find(socket);
+    if(file == socketFiles.end()) {
+        return;
+    }
+
+    const char* path = address.c_str() + strlen(unixPrefix);
+    struct stat info;
+    if(lstat(path, &info) == 0 && S_ISSOCK(info.st_mode) && info.st_dev == file->second.first && info.st_ino == file->second.second) {
+        unlink(path);
+    }
+    socketFiles.erase(file);
+#else
+    (void) address;
+    WSACleanup();
+#endif
+}
+
+intptr_t acceptConnection(intptr_t socket, int timeoutMs) {
+#ifdef WIN32
+    WSAPOLLFD listenPoll = { SOCKET(socket), POLLIN, 0 };
+    if(WSAPoll(&listenPoll, 1, timeoutMs) <= 0) {
+        return invalidSocket;
+    }
+#else
+    pollfd listenPoll = { int(socket), POLLIN, 0 };
+    if(poll(&listenPoll, 1, timeoutMs) <= 0) {
+        return invalidSocket;
+    }
+#endif
+
+    return intptr_t(accept(socket, nullptr, nullptr));
+}
+
+intptr_t connectSocket(const std::string& address) {
+#ifdef WIN32
+    if(!startSockets("client")) {
+        return invalidSocket;
+    }
+#endif
+
+    sockaddr_storage socketAddress;
+    socklen_t addressSize = 0;
+    intptr_t fd = createSocket(address, socketAddress, addressSize, "client");
+    if(fd == invalidSocket) {
+        return invalidSocket;
+    }
+
+    if(connect(fd, (const sockaddr*) &socketAddress, addressSize) != 0) {
+        std::cerr << "  Could not connect to " << address << ": " << strerror(errno) << std::endl;
+        closeSocket(fd);
+        return invalidSocket;
+    }
+
+    return fd;
+}
+
+void closeSocket(intptr_t socket) {
+#ifdef WIN32
+    closesocket(SOCKET(socket));
+#else
+    close(int(socket));
+#endif
+}
+
+void setSocketTimeout(intptr_t socket, int timeoutMs) {
+#ifdef WIN32
+    DWORD timeout = DWORD(timeoutMs);
+#else
+    timeval timeout = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+#endif
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, (const char*) &timeout, sizeof(timeout));
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, (const char*) &timeout, sizeof(timeout));
+}
+
+bool sendAll(intptr_t socket, const void* data, size_t size) {
+    const char* bytes = (const char*) data;
+    size_t sent = 0;
+    while(sent < size) {
+        auto count = send(socket, bytes + sent, int(size - sent), MSG_NOSIGNAL);
+        if(count <= 0) {
+            return false;
+        }
+        sent += size_t(count);
+    }
+    return true;
+}
+
+bool receiveAll(intptr_t socket, void* data, size_t size) {
+    char* bytes = (char*) data;
+    size_t received = 0;
+    while(received < size) {
+        auto count = recv(socket, bytes + received, int(size - received), 0);
+        if(count <= 0) {
+            return false;
+        }
+        received += size_t(count);
+    }
+    return true;
+}
+
+long receiveSome(intptr_t socket, void* data, size_t size) {
+    return long(recv(socket, (char*) data, int(size), 0));
+}
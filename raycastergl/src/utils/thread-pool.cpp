@@ -0,0 +1,82 @@
+#include <utils/thread-pool.hpp>
+#include <algorithm>
+#include <atomic>
+
+size_t ThreadPool::defaultThreadCount() {
+    const size_t cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 1;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    threads.reserve(threadCount);
+    for(size_t i = 0; i < threadCount; i += 1) {
+        threads.emplace_back([this] () { run(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wakeUp.notify_all();
+    for(auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::run() {
+    while(true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this] () { return stopping || !tasks.empty(); });
+            if(tasks.empty()) {
+                return;
+            }
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+void ThreadPool::push(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+
+    wakeUp.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    // the indices are taken one by one, so the slow parts do not leave the other threads waiting
+    std::atomic<size_t> next = 0;
+    const auto work = [&] () {
+        for(size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            body(i);
+        }
+    };
+
+    std::mutex finishedMutex;
+    std::condition_variable finished;
+    size_t pending = std::min(threads.size(), count > 0 ? count - 1 : 0);
+    for(size_t i = 0, helpers = pending; i < helpers; i += 1) {
+        push([&] () {
+            work();
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            pending -= 1;
+            if(pending == 0) {
+                finished.notify_one();
+            }
+        });
+    }
+
+    work();
+    std::unique_lock<std::mutex> lock(finishedMutex);
+    finished.wait(lock, [&] () { return pending == 0; });
+}
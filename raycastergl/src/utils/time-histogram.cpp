@@ -0,0 +1,70 @@
+#include <utils/time-histogram.hpp>
+#include <algorithm>
+#include <cmath>
+
+// index of the bucket for a duration in microseconds: the values below 128 have their own bucket, and
+// then each power of two is divided into 64 buckets
+static size_t bucketIndex(uint64_t us, uint32_t subBucketBits) {
+    uint32_t magnitude = 0;
+    while((us >> magnitude) >= (2u << subBucketBits)) {
+        magnitude += 1;
+    }
+
+    return (size_t(magnitude) << subBucketBits) + (us >> magnitude);
+}
+
+void TimeHistogram::record(double ms) {
+    const uint64_t us = std::min(uint64_t(std::max(ms, 0.0) * 1000.0 + 0.5), (uint64_t(1) << valueBits) - 1);
+    counts[bucketIndex(us, subBucketBits)] += 1;
+    total += 1;
+    sumMs += ms;
+    maxMs = std::max(maxMs, ms);
+}
+
+void TimeHistogram::merge(const TimeHistogram& other) {
+    for(size_t i = 0; i < bucketCount; i++) {
+        counts[i] += other.counts[i];
+    }
+
+    total += other.total;
+    sumMs += other.sumMs;
+    maxMs = std::max(maxMs, other.maxMs);
+}
+
+void TimeHistogram::reset() {
+    counts.fill(0);
+    total = 0;
+    sumMs = 0.0;
+    maxMs = 0.0;
+}
+
+double TimeHistogram::percentile(double percent) const {
+    if(total == 0) {
+        return 0.0;
+    }
+
+    const uint64_t target = std::max(uint64_t(std::ceil(percent / 100.0 * total)), uint64_t(1));
+    uint64_t accumulated = 0;
+    for(size_t i = 0; i < bucketCount; i++) {
+        accumulated += counts[i];
+        if(accumulated >= target) {
+            // the middle of the bucket can be above the real maximum
+            return std::min(bucketMs(i), maxMs);
+        }
+    }
+
+    return maxMs;
+}
+
+double TimeHistogram::bucketMs(size_t bucket) {
+    uint32_t magnitude = 0;
+    uint64_t subBucket = bucket;
+    if(bucket >= 2 * subBucketCount) {
+        magnitude = uint32_t(bucket >> subBucketBits) - 1;
+        subBucket = bucket - (size_t(magnitude) << subBucketBits);
+    }
+
+    const uint64_t low = subBucket << magnitude;
+    const uint64_t width = uint64_t(1) << magnitude;
+    return (low + (width - 1) / 2.0) / 1000.0;
+}